@@ -0,0 +1,136 @@
+#include "ipfs_client.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <format>
+
+namespace {
+
+std::string recordedPinList(int rows) {
+    std::string body = std::format(R"({{"count":{},"rows":[)", rows);
+    for (int i = 0; i < rows; ++i) {
+        if (i > 0) body += ',';
+        body += std::format(R"({{"id":"{:08x}-4e5b-4f6a-9c3d-2b7e1f0a{:04x}","ipfs_pin_hash":"QmYwAPJzv5CZsnA625s3Xf2nemtYgPpHdWEz79ojWnPbd{:03}",)"
+                            R"("size":{},"user_id":"a1b2c3d4-e5f6-7890-abcd-ef1234567890","date_pinned":"2024-05-{:02}T12:34:56.789Z","date_unpinned":null,)"
+                            R"("metadata":{{"name":"backup-{}.tar","keyvalues":{{"host":"worker-{}","batch":"{}"}}}},)"
+                            R"("regions":[{{"regionId":"FRA1","currentReplicationCount":1,"desiredReplicationCount":1}}],"mime_type":"application/x-tar","number_of_files":1}})",
+                            i, i, i % 1000, 4096 + i * 37, 1 + i % 28, i, i % 16, i / 100);
+    }
+    body += "]}";
+    return body;
+}
+
+const std::string uploadResponse = R"({"IpfsHash":"QmYwAPJzv5CZsnA625s3Xf2nemtYgPpHdWEz79ojWnPbdG","PinSize":1048576,"Timestamp":"2024-05-14T12:34:56.789Z","isDuplicate":false})";
+
+void BM_ParseUploadResponse(benchmark::State& state) {
+    for (auto _ : state) {
+        auto json = IPFSClient::parseJSON(uploadResponse);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * uploadResponse.size()));
+}
+BENCHMARK(BM_ParseUploadResponse);
+
+void BM_ParsePinList(benchmark::State& state) {
+    std::string body = recordedPinList(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        auto json = IPFSClient::parseJSON(body);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * body.size()));
+}
+BENCHMARK(BM_ParsePinList)->Arg(10)->Arg(1000);
+
+void BM_SerializeMetadata(benchmark::State& state) {
+    Json::Value metadata;
+    metadata["name"] = "nightly-backups";
+    metadata["keyvalues"]["host"] = "worker-07";
+    metadata["keyvalues"]["batch"] = "2024-05-14";
+    for (auto _ : state) {
+        std::string serialized = IPFSClient::serializeMetadata(metadata);
+        benchmark::DoNotOptimize(serialized);
+    }
+}
+BENCHMARK(BM_SerializeMetadata);
+
+void BM_BuildRequestUrl(benchmark::State& state) {
+    const std::string baseUrl = "https://api.pinata.cloud/pinning/unpin/";
+    const std::string hash = "ipfs://QmYwAPJzv5CZsnA625s3Xf2nemtYgPpHdWEz79ojWnPbdG";
+    for (auto _ : state) {
+        std::string url = IPFSClient::requestUrl(baseUrl, {stripIpfsScheme(hash)});
+        benchmark::DoNotOptimize(url.data());
+    }
+}
+BENCHMARK(BM_BuildRequestUrl);
+
+void BM_BuildAuthHeaders(benchmark::State& state) {
+    Config config;
+    config.pinataApiKey = std::string(20, 'k');
+    config.pinataSecret = std::string(64, 's');
+    const bool multipart = state.range(0) != 0;
+    for (auto _ : state) {
+        curl_slist* headers = IPFSClient::authHeaderList(config, multipart);
+        benchmark::DoNotOptimize(headers);
+        curl_slist_free_all(headers);
+    }
+}
+BENCHMARK(BM_BuildAuthHeaders)->Arg(0)->Arg(1);
+
+void BM_ErrorToString(benchmark::State& state) {
+    const auto error = std::make_pair(IPFSError::PinataError, std::string("Pinata response missing IpfsHash: {\"error\":\"Invalid request format\"}"));
+    for (auto _ : state) {
+        std::string text = IPFSClient::errorToString(error);
+        benchmark::DoNotOptimize(text);
+    }
+}
+BENCHMARK(BM_ErrorToString);
+
+void BM_ResponseBuffering(benchmark::State& state) {
+    BufferPool pool;
+    const size_t bodySize = static_cast<size_t>(state.range(0));
+    const bool contentLength = state.range(1) != 0;
+    std::string header = std::format("Content-Length: {}\r\n", bodySize);
+    std::string chunk(16 * 1024, 'x');
+    for (auto _ : state) {
+        BufferPool::Lease lease = pool.acquire();
+        ResponseSink sink{&pool, &lease.buffer()};
+        if (contentLength) headerCallback(header.data(), 1, header.size(), &sink);
+        for (size_t received = 0; received < bodySize; received += chunk.size()) {
+            writeCallback(chunk.data(), 1, std::min(chunk.size(), bodySize - received), &sink);
+        }
+        benchmark::DoNotOptimize(lease.str().data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bodySize));
+}
+BENCHMARK(BM_ResponseBuffering)->ArgsProduct({{4 * 1024, 256 * 1024, 8 * 1024 * 1024}, {0, 1}});
+
+void BM_LoggerEnabled(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        Logger::verboseMode = true;
+        Logger::setLevel(LogLevel::DEBUG);
+    }
+    for (auto _ : state) Logger::info("Uploaded {} to {}", "/data/backups/part-0001.tar", "ipfs://QmYwAPJzv5CZsnA625s3Xf2nemtYgPpHdWEz79ojWnPbdG");
+    if (state.thread_index() == 0) Logger::flush();
+}
+BENCHMARK(BM_LoggerEnabled)->Threads(1)->Threads(8)->Threads(64)->UseRealTime();
+
+void BM_LoggerDisabledLevel(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        Logger::verboseMode = true;
+        Logger::setLevel(LogLevel::WARN);
+    }
+    for (auto _ : state) Logger::debug("Response: {}", uploadResponse);
+}
+BENCHMARK(BM_LoggerDisabledLevel)->Threads(1)->Threads(8)->Threads(64)->UseRealTime();
+
+}
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    std::FILE* devNull = std::fopen("/dev/null", "w");
+    if (!devNull) return 1;
+    Logger::setOutput(devNull);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "ipfs_client.hpp"
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+bool sendAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+        data.remove_prefix(static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+void serveConnection(int fd) {
+    std::vector<char> buffer(256 * 1024);
+    std::string pending;
+    for (;;) {
+        size_t headerEnd;
+        while ((headerEnd = pending.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t received = ::recv(fd, buffer.data(), buffer.size(), 0);
+            if (received <= 0) {
+                ::close(fd);
+                return;
+            }
+            pending.append(buffer.data(), static_cast<size_t>(received));
+        }
+        std::string head = pending.substr(0, headerEnd + 4);
+        pending.erase(0, headerEnd + 4);
+        std::transform(head.begin(), head.end(), head.begin(), [](unsigned char c) { return std::tolower(c); });
+
+        size_t contentLength = 0;
+        if (auto pos = head.find("content-length:"); pos != std::string::npos) contentLength = std::stoull(head.substr(pos + 15));
+        if (head.find("expect: 100-continue") != std::string::npos && !sendAll(fd, "HTTP/1.1 100 Continue\r\n\r\n")) break;
+
+        size_t consumed = std::min(contentLength, pending.size());
+        pending.erase(0, consumed);
+        size_t remaining = contentLength - consumed;
+        while (remaining > 0) {
+            ssize_t received = ::recv(fd, buffer.data(), std::min(buffer.size(), remaining), 0);
+            if (received <= 0) {
+                ::close(fd);
+                return;
+            }
+            remaining -= static_cast<size_t>(received);
+        }
+
+        std::string body = R"({"IpfsHash":"QmUploadSourceBench"})";
+        std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+        if (!sendAll(fd, response)) break;
+    }
+    ::close(fd);
+}
+
+[[noreturn]] void runSink(int listener) {
+    for (;;) {
+        int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        std::thread(serveConnection, fd).detach();
+    }
+}
+
+double cpuSeconds() {
+    rusage usage {};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+void runMode(const char* name, UploadSourceMode mode, const std::string& url, const std::string& file, size_t fileSize, int iterations) {
+    Config config;
+    config.apiUrl = url;
+    config.pinataApiKey = "bench";
+    config.pinataSecret = "bench";
+    config.uploadSource = mode;
+    IPFSClient client(config);
+    if (!client.performUpload(file, std::nullopt, 0)) {
+        std::cerr << name << ": warm-up upload failed\n";
+        return;
+    }
+
+    double cpuStart = cpuSeconds();
+    auto wallStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        auto result = client.performUpload(file, std::nullopt, 0);
+        if (!result) {
+            std::cerr << name << ": " << IPFSClient::errorToString(result.error()) << "\n";
+            return;
+        }
+    }
+    double cpu = cpuSeconds() - cpuStart;
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double gigabytes = static_cast<double>(fileSize) * iterations / (1024.0 * 1024.0 * 1024.0);
+    std::cout << std::format("{:<8} cpu {:8.3f} s/GB   wall {:9.1f} MB/s\n", name, cpu / gigabytes, gigabytes * 1024.0 / wall);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t sizeMb = 256;
+    int iterations = 8;
+    for (int i = 1; i < argc - 1; i += 2) {
+        std::string option = argv[i];
+        if (option == "--size-mb") sizeMb = std::stoul(argv[i + 1]);
+        else if (option == "--iterations") iterations = std::stoi(argv[i + 1]);
+    }
+
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressLength = sizeof(address);
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 64) != 0
+        || ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &addressLength) != 0) {
+        std::cerr << "Could not start sink server: " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    pid_t sink = ::fork();
+    if (sink == 0) runSink(listener);
+    ::close(listener);
+
+    fs::path file = fs::temp_directory_path() / std::format("pinatapipe-upload-bench-{}.bin", ::getpid());
+    size_t fileSize = sizeMb * 1024 * 1024;
+    {
+        std::ofstream out(file, std::ios::binary);
+        std::mt19937_64 random(42);
+        std::vector<uint64_t> block(1024 * 1024 / sizeof(uint64_t));
+        for (size_t written = 0; written < fileSize; written += 1024 * 1024) {
+            std::generate(block.begin(), block.end(), random);
+            out.write(reinterpret_cast<const char*>(block.data()), 1024 * 1024);
+        }
+    }
+
+    std::string url = std::format("http://127.0.0.1:{}/", ntohs(address.sin_port));
+    curl_global_init(CURL_GLOBAL_ALL);
+    std::cout << std::format("Uploading {} MiB x {} to {}\n", sizeMb, iterations, url);
+    try {
+        runMode("stdio", UploadSourceMode::Stdio, url, file.string(), fileSize, iterations);
+        runMode("mapped", UploadSourceMode::Mapped, url, file.string(), fileSize, iterations);
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << "\n";
+    }
+    curl_global_cleanup();
+
+    fs::remove(file);
+    ::kill(sink, SIGTERM);
+    ::waitpid(sink, nullptr, 0);
+    return 0;
+}
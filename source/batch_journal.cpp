@@ -0,0 +1,215 @@
+#include "batch_journal.hpp"
+#include "logger.hpp"
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::string escape(std::string_view text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\t': escaped += "\\t"; break;
+        default: escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+std::string unescape(std::string_view text) {
+    std::string plain;
+    plain.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '\\' || i + 1 == text.size()) {
+            plain += text[i];
+            continue;
+        }
+        char next = text[++i];
+        plain += next == 'n' ? '\n' : next == 't' ? '\t' : next;
+    }
+    return plain;
+}
+
+bool syncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#if defined(_WIN32)
+    return ::_commit(::_fileno(file)) == 0;
+#elif defined(__linux__)
+    return ::fdatasync(::fileno(file)) == 0;
+#else
+    return ::fsync(::fileno(file)) == 0;
+#endif
+}
+
+void syncDirectory(const std::filesystem::path& path) {
+#ifndef _WIN32
+    std::filesystem::path directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return;
+    ::fsync(fd);
+    ::close(fd);
+#else
+    (void)path;
+#endif
+}
+
+}
+
+std::expected<BatchJournal, std::string> BatchJournal::create(const std::string& path, const std::vector<std::string>& files, const std::optional<Json::Value>& metadata) {
+    std::FILE* file = std::fopen(path.c_str(), "wbx");
+    if (!file) {
+        if (errno == EEXIST) return std::unexpected("Batch journal " + path + " already exists, continue it with --resume " + path);
+        return std::unexpected("Could not create batch journal " + path + ": " + std::strerror(errno));
+    }
+    BatchJournal journal(path, file);
+    journal.pending.append(Magic).append("\n");
+    if (metadata) {
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        journal.pending.append("metadata\t").append(escape(Json::writeString(writer, *metadata))).append("\n");
+        journal.batchMetadata = metadata;
+    }
+    std::filesystem::path cwd = std::filesystem::current_path();
+    journal.planned.reserve(files.size());
+    for (const auto& path : files) {
+        journal.planned.push_back((cwd / path).lexically_normal().string());
+        journal.pending.append("plan\t").append(escape(journal.planned.back())).append("\n");
+    }
+    journal.pending.append("started\n");
+    if (auto synced = journal.sync(); !synced) return std::unexpected(synced.error());
+    syncDirectory(path);
+    return journal;
+}
+
+std::expected<BatchJournal, std::string> BatchJournal::resume(const std::string& path) {
+    BatchJournal journal(path, nullptr);
+    if (auto loaded = journal.load(); !loaded) return std::unexpected(loaded.error());
+    journal.file = std::fopen(path.c_str(), "ab");
+    if (!journal.file) return std::unexpected("Could not open batch journal " + path + ": " + std::strerror(errno));
+    return journal;
+}
+
+BatchJournal::BatchJournal(BatchJournal&& other) noexcept
+    : path(std::move(other.path)), file(std::exchange(other.file, nullptr)), planned(std::move(other.planned)), batchMetadata(std::move(other.batchMetadata)),
+      cids(std::move(other.cids)), failures(std::move(other.failures)), pending(std::move(other.pending)), unsynced(other.unsynced), lastSync(other.lastSync) {}
+
+BatchJournal& BatchJournal::operator=(BatchJournal&& other) noexcept {
+    if (this != &other) {
+        if (file) {
+            sync();
+            std::fclose(file);
+        }
+        path = std::move(other.path);
+        file = std::exchange(other.file, nullptr);
+        planned = std::move(other.planned);
+        batchMetadata = std::move(other.batchMetadata);
+        cids = std::move(other.cids);
+        failures = std::move(other.failures);
+        pending = std::move(other.pending);
+        unsynced = other.unsynced;
+        lastSync = other.lastSync;
+    }
+    return *this;
+}
+
+BatchJournal::~BatchJournal() {
+    if (!file) return;
+    if (auto synced = sync(); !synced) Logger::warn("{}", synced.error());
+    std::fclose(file);
+}
+
+std::expected<void, std::string> BatchJournal::load() {
+    std::FILE* input = std::fopen(path.c_str(), "rb");
+    if (!input) return std::unexpected("Could not open batch journal " + path + ": " + std::strerror(errno));
+    std::string data;
+    char buffer[256 * 1024];
+    for (size_t count; (count = std::fread(buffer, 1, sizeof(buffer), input)) > 0;) data.append(buffer, count);
+    std::fclose(input);
+
+    if (!data.starts_with(std::string(Magic) + "\n")) return std::unexpected(path + " is not a batch journal");
+    size_t complete = data.rfind('\n') + 1;
+    bool started = false;
+    std::string_view remainingData(data.data(), complete);
+    remainingData.remove_prefix(Magic.size() + 1);
+    while (!remainingData.empty()) {
+        size_t end = remainingData.find('\n');
+        std::string_view line = remainingData.substr(0, end);
+        remainingData.remove_prefix(end + 1);
+        size_t tab = line.find('\t');
+        std::string_view kind = line.substr(0, tab);
+        std::string_view rest = tab == std::string_view::npos ? std::string_view() : line.substr(tab + 1);
+        if (kind == "started") {
+            started = true;
+        } else if (kind == "plan") {
+            planned.push_back(unescape(rest));
+        } else if (kind == "metadata") {
+            auto json = IPFSClient::parseJSON(unescape(rest));
+            if (!json) return std::unexpected("Batch journal " + path + " has invalid metadata");
+            batchMetadata = *json;
+        } else if (kind == "done" || kind == "failed") {
+            size_t split = rest.find('\t');
+            if (split == std::string_view::npos) continue;
+            std::string file = unescape(rest.substr(split + 1));
+            std::string detail = unescape(rest.substr(0, split));
+            if (kind == "done") {
+                failures.erase(file);
+                cids.insert_or_assign(std::move(file), std::move(detail));
+            } else if (!cids.contains(file)) {
+                failures.insert_or_assign(std::move(file), std::move(detail));
+            }
+        }
+    }
+    if (!started) return std::unexpected("Batch journal " + path + " was interrupted before the batch started, run the batch again");
+    if (complete < data.size()) {
+        std::error_code ec;
+        std::filesystem::resize_file(path, complete, ec);
+        if (ec) return std::unexpected("Could not drop the torn tail of " + path + ": " + ec.message());
+        Logger::warn("Dropped a partially written record at the end of {}", path);
+    }
+    return {};
+}
+
+std::vector<std::string> BatchJournal::remaining() const {
+    std::vector<std::string> files;
+    for (const auto& file : planned) {
+        if (!cids.contains(file)) files.push_back(file);
+    }
+    return files;
+}
+
+void BatchJournal::record(const std::string& file, const Result<std::string>& result) {
+    if (result) {
+        pending.append("done\t").append(escape(*result));
+        failures.erase(file);
+        cids.insert_or_assign(file, *result);
+    } else {
+        std::string error = IPFSClient::errorToString(result.error());
+        pending.append("failed\t").append(escape(error));
+        failures.insert_or_assign(file, std::move(error));
+    }
+    pending.append("\t").append(escape(file)).append("\n");
+    if (++unsynced < SyncEvery && std::chrono::steady_clock::now() - lastSync < SyncInterval) return;
+    if (auto synced = sync(); !synced) Logger::warn("{}", synced.error());
+}
+
+std::expected<void, std::string> BatchJournal::sync() {
+    if (!file) return {};
+    bool written = pending.empty() || std::fwrite(pending.data(), 1, pending.size(), file) == pending.size();
+    pending.clear();
+    unsynced = 0;
+    lastSync = std::chrono::steady_clock::now();
+    if (!written || !syncFile(file)) return std::unexpected("Could not write batch journal " + path + ": " + std::strerror(errno));
+    return {};
+}
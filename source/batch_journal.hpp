@@ -0,0 +1,56 @@
+#ifndef BATCH_JOURNAL_HPP
+#define BATCH_JOURNAL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <json/json.h>
+#include "ipfs_client.hpp"
+
+class BatchJournal {
+public:
+    static constexpr std::string_view Magic = "PPBJ 1";
+    static constexpr size_t SyncEvery = 64;
+    static constexpr std::chrono::milliseconds SyncInterval{1000};
+
+    static std::expected<BatchJournal, std::string> create(const std::string& path, const std::vector<std::string>& files, const std::optional<Json::Value>& metadata);
+    static std::expected<BatchJournal, std::string> resume(const std::string& path);
+
+    BatchJournal(BatchJournal&& other) noexcept;
+    BatchJournal& operator=(BatchJournal&& other) noexcept;
+    BatchJournal(const BatchJournal&) = delete;
+    BatchJournal& operator=(const BatchJournal&) = delete;
+    ~BatchJournal();
+
+    const std::vector<std::string>& files() const { return planned; }
+    const std::optional<Json::Value>& metadata() const { return batchMetadata; }
+    const std::unordered_map<std::string, std::string>& uploaded() const { return cids; }
+    const std::unordered_map<std::string, std::string>& failed() const { return failures; }
+    std::vector<std::string> remaining() const;
+
+    void record(const std::string& file, const Result<std::string>& result);
+    std::expected<void, std::string> sync();
+
+private:
+    BatchJournal(std::string path, std::FILE* file) : path(std::move(path)), file(file) {}
+
+    std::expected<void, std::string> load();
+
+    std::string path;
+    std::FILE* file = nullptr;
+    std::vector<std::string> planned;
+    std::optional<Json::Value> batchMetadata;
+    std::unordered_map<std::string, std::string> cids;
+    std::unordered_map<std::string, std::string> failures;
+    std::string pending;
+    size_t unsynced = 0;
+    std::chrono::steady_clock::time_point lastSync = std::chrono::steady_clock::now();
+};
+
+#endif
@@ -0,0 +1,70 @@
+#include "buffer_pool.hpp"
+#include <algorithm>
+#include <utility>
+
+BufferPool::Lease::Lease(BufferPool* pool, std::string buffer) : owner(pool), data(std::move(buffer)) {}
+
+BufferPool::Lease::Lease(Lease&& other) noexcept : owner(std::exchange(other.owner, nullptr)), data(std::move(other.data)) {}
+
+BufferPool::Lease& BufferPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        if (owner) owner->recycle(std::move(data));
+        owner = std::exchange(other.owner, nullptr);
+        data = std::move(other.data);
+    }
+    return *this;
+}
+
+BufferPool::Lease::~Lease() {
+    if (owner) owner->recycle(std::move(data));
+}
+
+std::string BufferPool::Lease::take() {
+    owner = nullptr;
+    return std::move(data);
+}
+
+BufferPool::BufferPool(size_t maxRetainedCapacity) : maxRetained(maxRetainedCapacity) {}
+
+BufferPool::Lease BufferPool::acquire() {
+    acquired.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (freeBuffers.empty()) return Lease(this, std::string());
+    reused.fetch_add(1, std::memory_order_relaxed);
+    std::string buffer = std::move(freeBuffers.back());
+    freeBuffers.pop_back();
+    return Lease(this, std::move(buffer));
+}
+
+void BufferPool::append(std::string& buffer, const char* data, size_t size) {
+    if (buffer.size() + size > buffer.capacity()) heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    buffer.append(data, size);
+    bytesReceived.fetch_add(size, std::memory_order_relaxed);
+}
+
+void BufferPool::reserve(std::string& buffer, size_t contentLength) {
+    size_t wanted = buffer.size() + std::min(contentLength, MaxContentLengthReservation);
+    if (wanted <= buffer.capacity()) return;
+    buffer.reserve(wanted);
+    reservations.fetch_add(1, std::memory_order_relaxed);
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+BufferPoolStats BufferPool::stats() const {
+    BufferPoolStats result;
+    result.acquired = acquired.load(std::memory_order_relaxed);
+    result.reused = reused.load(std::memory_order_relaxed);
+    result.heapAllocations = heapAllocations.load(std::memory_order_relaxed);
+    result.reservations = reservations.load(std::memory_order_relaxed);
+    result.bytesReceived = bytesReceived.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(poolMutex);
+    for (const auto& buffer : freeBuffers) result.retainedCapacity += buffer.capacity();
+    return result;
+}
+
+void BufferPool::recycle(std::string&& buffer) {
+    if (buffer.capacity() > maxRetained) return;
+    buffer.clear();
+    std::lock_guard<std::mutex> lock(poolMutex);
+    freeBuffers.push_back(std::move(buffer));
+}
@@ -0,0 +1,64 @@
+#ifndef BUFFER_POOL_HPP
+#define BUFFER_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct BufferPoolStats {
+    uint64_t acquired = 0;
+    uint64_t reused = 0;
+    uint64_t heapAllocations = 0;
+    uint64_t reservations = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t retainedCapacity = 0;
+};
+
+class BufferPool {
+public:
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(BufferPool* pool, std::string buffer);
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        std::string& buffer() { return data; }
+        const std::string& str() const { return data; }
+        std::string take();
+
+    private:
+        BufferPool* owner = nullptr;
+        std::string data;
+    };
+
+    static constexpr size_t DefaultMaxRetainedCapacity = 4 * 1024 * 1024;
+    static constexpr size_t MaxContentLengthReservation = 64 * 1024 * 1024;
+
+    explicit BufferPool(size_t maxRetainedCapacity = DefaultMaxRetainedCapacity);
+
+    Lease acquire();
+    void append(std::string& buffer, const char* data, size_t size);
+    void reserve(std::string& buffer, size_t contentLength);
+    BufferPoolStats stats() const;
+
+private:
+    void recycle(std::string&& buffer);
+
+    mutable std::mutex poolMutex;
+    std::vector<std::string> freeBuffers;
+    size_t maxRetained;
+    std::atomic<uint64_t> acquired{0};
+    std::atomic<uint64_t> reused{0};
+    std::atomic<uint64_t> heapAllocations{0};
+    std::atomic<uint64_t> reservations{0};
+    std::atomic<uint64_t> bytesReceived{0};
+};
+
+#endif
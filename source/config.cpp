@@ -23,5 +23,37 @@ std::expected<Config, std::pair<ConfigError, std::string>> Config::load() {
         return std::unexpected(std::make_pair(ConfigError::InvalidFormat, "Missing pinataApiKey or pinataSecret in config.json"));
     }
 
+    std::string uploadSource = root.get("uploadSource", "stdio").asString();
+    if (uploadSource == "stdio") config.uploadSource = UploadSourceMode::Stdio;
+    else if (uploadSource == "mapped") config.uploadSource = UploadSourceMode::Mapped;
+    else if (uploadSource == "bulk") config.uploadSource = UploadSourceMode::Bulk;
+    else return std::unexpected(std::make_pair(ConfigError::InvalidFormat, "uploadSource must be \"stdio\", \"mapped\" or \"bulk\""));
+    config.uploadBufferSize = root.get("uploadBufferSize", static_cast<Json::Int64>(config.uploadBufferSize)).asInt64();
+    config.bulkDirectIO = root.get("bulkDirectIO", false).asBool();
+    config.apiUrl = withTrailingSlash(root.get("apiUrl", PINATA_URL).asString());
+    config.gatewayUrl = withTrailingSlash(root.get("gatewayUrl", IPFS_GATEWAY).asString());
+    auto keyValidation = parseKeyValidation(root.get("keyValidation", "eager").asString());
+    if (!keyValidation) return std::unexpected(std::make_pair(ConfigError::InvalidFormat, "keyValidation must be \"eager\", \"lazy\", \"cached\" or \"async\""));
+    config.keyValidation = *keyValidation;
+    config.keyValidationTtl = root.get("keyValidationTtl", static_cast<Json::Int64>(config.keyValidationTtl)).asInt64();
+    config.keyCachePath = root.get("keyCachePath", "").asString();
+    config.prewarmConnections = root.get("prewarmConnections", false).asBool();
+    config.connectionCache = root.get("connectionCache", false).asBool();
+    config.connectionCachePath = root.get("connectionCachePath", "").asString();
+    config.dnsCacheTtl = root.get("dnsCacheTtl", static_cast<Json::Int64>(config.dnsCacheTtl)).asInt64();
+
     return config;
 }
+
+std::string Config::withTrailingSlash(std::string url) {
+    if (!url.empty() && url.back() != '/') url += '/';
+    return url;
+}
+
+std::optional<KeyValidation> Config::parseKeyValidation(std::string_view name) {
+    if (name == "eager") return KeyValidation::Eager;
+    if (name == "lazy") return KeyValidation::Lazy;
+    if (name == "cached") return KeyValidation::Cached;
+    if (name == "async") return KeyValidation::Async;
+    return std::nullopt;
+}
@@ -2,18 +2,36 @@
 #define CONFIG_HPP
 
 #include <string>
+#include <string_view>
 #include <expected>
+#include <optional>
 
 enum class ConfigError { FileNotFound, InvalidFormat };
+enum class UploadSourceMode { Stdio, Mapped, Bulk };
+enum class KeyValidation { Eager, Lazy, Cached, Async };
 
 class Config {
 public:
-    static inline const char* PINATA_URL = "https://api.pinata.cloud/";
-    static inline const char* IPFS_GATEWAY = "https://ipfs.io/ipfs/";
+    static constexpr const char* PINATA_URL = "https://api.pinata.cloud/";
+    static constexpr const char* IPFS_GATEWAY = "https://ipfs.io/ipfs/";
+    std::string apiUrl = PINATA_URL;
+    std::string gatewayUrl = IPFS_GATEWAY;
     std::string pinataApiKey;
     std::string pinataSecret;
+    UploadSourceMode uploadSource = UploadSourceMode::Stdio;
+    long uploadBufferSize = 1024 * 1024;
+    bool bulkDirectIO = false;
+    KeyValidation keyValidation = KeyValidation::Eager;
+    long keyValidationTtl = 24 * 60 * 60;
+    std::string keyCachePath;
+    bool prewarmConnections = false;
+    bool connectionCache = false;
+    std::string connectionCachePath;
+    long dnsCacheTtl = 5 * 60;
 
     static std::expected<Config, std::pair<ConfigError, std::string>> load();
+    static std::string withTrailingSlash(std::string url);
+    static std::optional<KeyValidation> parseKeyValidation(std::string_view name);
 };
 
 #endif
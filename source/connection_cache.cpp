@@ -0,0 +1,190 @@
+#include "connection_cache.hpp"
+#include "logger.hpp"
+#include "private_file.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string_view>
+#include <tuple>
+
+namespace {
+
+constexpr int64_t DefaultSessionLifetime = 2 * 60 * 60;
+
+int64_t unixNow() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string toHex(std::string_view bytes) {
+    std::string result;
+    result.reserve(bytes.size() * 2);
+    for (unsigned char byte : bytes) std::format_to(std::back_inserter(result), "{:02x}", byte);
+    return result;
+}
+
+bool fromHex(std::string_view hex, std::string& out) {
+    if (hex.size() % 2 != 0) return false;
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    };
+    out.clear();
+    out.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int high = nibble(hex[i]);
+        int low = nibble(hex[i + 1]);
+        if (high < 0 || low < 0) return false;
+        out += static_cast<char>(high << 4 | low);
+    }
+    return true;
+}
+
+bool hostAndPort(const std::string& url, std::string& host, long& port) {
+    CURLU* parsed = curl_url();
+    if (!parsed) return false;
+    char* hostPart = nullptr;
+    char* portPart = nullptr;
+    bool ok = curl_url_set(parsed, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK && curl_url_get(parsed, CURLUPART_HOST, &hostPart, 0) == CURLUE_OK &&
+              curl_url_get(parsed, CURLUPART_PORT, &portPart, CURLU_DEFAULT_PORT) == CURLUE_OK;
+    if (ok) {
+        host = hostPart;
+        port = std::strtol(portPart, nullptr, 10);
+    }
+    curl_free(hostPart);
+    curl_free(portPart);
+    curl_url_cleanup(parsed);
+    return ok;
+}
+
+#if LIBCURL_VERSION_NUM >= 0x080c00
+CURLcode exportSession(CURL*, void* userptr, const char* sessionKey, const unsigned char* hmac, size_t hmacLength, const unsigned char* data, size_t dataLength,
+                       curl_off_t validUntil, int, const char*, size_t) {
+    auto* exported = static_cast<std::vector<std::tuple<std::string, std::string, std::string, int64_t>>*>(userptr);
+    exported->emplace_back(sessionKey, std::string(reinterpret_cast<const char*>(hmac), hmacLength), std::string(reinterpret_cast<const char*>(data), dataLength),
+                           static_cast<int64_t>(validUntil));
+    return CURLE_OK;
+}
+#endif
+
+}
+
+ConnectionCache::ConnectionCache(std::filesystem::path path, std::chrono::seconds dnsTtl) : path(std::move(path)), dnsTtl(dnsTtl) {
+    load();
+}
+
+std::filesystem::path ConnectionCache::defaultPath() {
+    return userCacheDirectory() / "connections";
+}
+
+bool ConnectionCache::sessionsSupported() {
+#if LIBCURL_VERSION_NUM >= 0x080c00
+    return curl_version_info(CURLVERSION_NOW)->version_num >= 0x080c00;
+#else
+    return false;
+#endif
+}
+
+void ConnectionCache::load() {
+    std::ifstream file(path);
+    std::string line;
+    int64_t now = unixNow();
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string kind;
+        fields >> kind;
+        if (kind == "dns") {
+            Address address;
+            if (fields >> address.host >> address.port >> address.ip >> address.expires && address.expires > now) addresses.push_back(std::move(address));
+        } else if (kind == "tls") {
+            Session session;
+            std::string key, hmac, data;
+            if (fields >> session.expires >> key >> hmac >> data && session.expires > now && fromHex(key, session.key) && fromHex(hmac, session.hmac) &&
+                fromHex(data, session.data)) {
+                sessions.push_back(std::move(session));
+            }
+        }
+    }
+}
+
+curl_slist* ConnectionCache::resolveOverrides() const {
+    curl_slist* list = nullptr;
+    for (const Address& address : addresses) {
+        std::string entry = std::format("+{}:{}:{}", address.host, address.port, address.ip);
+        if (curl_slist* next = curl_slist_append(list, entry.c_str())) list = next;
+    }
+    return list;
+}
+
+void ConnectionCache::rememberAddress(const std::string& url, CURL* curl) {
+    char* ip = nullptr;
+    std::string host;
+    long port = 0;
+    if (curl_easy_getinfo(curl, CURLINFO_PRIMARY_IP, &ip) != CURLE_OK || !ip || !*ip || !hostAndPort(url, host, port)) return;
+    if (host == ip || host.starts_with('[')) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto existing = std::ranges::find_if(addresses, [&](const Address& address) { return address.host == host && address.port == port; });
+    if (existing != addresses.end() && existing->ip == ip) return;
+    if (existing != addresses.end()) addresses.erase(existing);
+    addresses.push_back({std::move(host), port, ip, unixNow() + dnsTtl.count()});
+    dirty = true;
+}
+
+void ConnectionCache::forgetAddress(const std::string& url) {
+    std::string host;
+    long port = 0;
+    if (!hostAndPort(url, host, port)) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (std::erase_if(addresses, [&](const Address& address) { return address.host == host && address.port == port; }) > 0) dirty = true;
+}
+
+void ConnectionCache::importSessions(CURL* curl) {
+#if LIBCURL_VERSION_NUM >= 0x080c00
+    if (!sessionsSupported()) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t imported = 0;
+    for (const Session& session : sessions) {
+        CURLcode res = curl_easy_ssls_import(curl, session.key.c_str(), reinterpret_cast<const unsigned char*>(session.hmac.data()), session.hmac.size(),
+                                             reinterpret_cast<const unsigned char*>(session.data.data()), session.data.size());
+        if (res == CURLE_OK) ++imported;
+    }
+    if (imported > 0) Logger::debug("Imported {} cached TLS sessions", imported);
+#else
+    (void)curl;
+#endif
+}
+
+void ConnectionCache::exportSessions(CURL* curl) {
+#if LIBCURL_VERSION_NUM >= 0x080c00
+    if (!sessionsSupported()) return;
+    std::vector<std::tuple<std::string, std::string, std::string, int64_t>> exported;
+    if (curl_easy_ssls_export(curl, exportSession, &exported) != CURLE_OK || exported.empty()) return;
+    int64_t now = unixNow();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [key, hmac, data, expires] : exported) {
+        std::erase_if(sessions, [&](const Session& session) { return session.key == key; });
+        sessions.push_back({std::move(key), std::move(hmac), std::move(data), expires > 0 ? expires : now + DefaultSessionLifetime});
+    }
+    dirty = true;
+#else
+    (void)curl;
+#endif
+}
+
+void ConnectionCache::save() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!dirty) return;
+    int64_t now = unixNow();
+    std::string contents;
+    for (const Address& address : addresses) {
+        if (address.expires > now) std::format_to(std::back_inserter(contents), "dns {} {} {} {}\n", address.host, address.port, address.ip, address.expires);
+    }
+    for (const Session& session : sessions) {
+        if (session.expires > now) std::format_to(std::back_inserter(contents), "tls {} {} {} {}\n", session.expires, toHex(session.key), toHex(session.hmac), toHex(session.data));
+    }
+    if (auto written = writePrivateFile(path, contents); !written) Logger::warn("Could not update connection cache: {}", written.error());
+    else dirty = false;
+}
@@ -0,0 +1,51 @@
+#ifndef CONNECTION_CACHE_HPP
+#define CONNECTION_CACHE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+
+class ConnectionCache {
+public:
+    ConnectionCache(std::filesystem::path path, std::chrono::seconds dnsTtl);
+
+    curl_slist* resolveOverrides() const;
+    void rememberAddress(const std::string& url, CURL* curl);
+    void forgetAddress(const std::string& url);
+    void importSessions(CURL* curl);
+    void exportSessions(CURL* curl);
+    void save();
+
+    static std::filesystem::path defaultPath();
+    static bool sessionsSupported();
+
+private:
+    struct Address {
+        std::string host;
+        long port = 0;
+        std::string ip;
+        int64_t expires = 0;
+    };
+
+    struct Session {
+        std::string key;
+        std::string hmac;
+        std::string data;
+        int64_t expires = 0;
+    };
+
+    void load();
+
+    std::filesystem::path path;
+    std::chrono::seconds dnsTtl;
+    std::mutex mutex;
+    std::vector<Address> addresses;
+    std::vector<Session> sessions;
+    bool dirty = false;
+};
+
+#endif
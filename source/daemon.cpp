@@ -0,0 +1,426 @@
+#include "daemon.hpp"
+#include "ipfs_client.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <utility>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t ReadChunk = 64 * 1024;
+
+#ifndef _WIN32
+bool sendAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        data.remove_prefix(static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+bool receiveMore(int fd, std::string& pending) {
+    char buffer[ReadChunk];
+    for (;;) {
+        ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        pending.append(buffer, static_cast<size_t>(received));
+        return true;
+    }
+}
+
+std::expected<sockaddr_un, std::string> socketAddress(const std::string& path) {
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) return std::unexpected("Socket path is empty or too long: " + path);
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+int connectTo(const sockaddr_un& address) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+std::string fallbackSocketDirectory() {
+    return "/tmp/pinatapipe-" + std::to_string(::getuid());
+}
+
+std::expected<void, std::string> privateDirectory(const std::string& directory) {
+    if (::mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) return std::unexpected("Could not create " + directory + ": " + std::strerror(errno));
+    struct stat info {};
+    if (::lstat(directory.c_str(), &info) != 0) return std::unexpected("Could not stat " + directory + ": " + std::strerror(errno));
+    if (!S_ISDIR(info.st_mode) || info.st_uid != ::getuid() || (info.st_mode & 077) != 0) {
+        return std::unexpected(directory + " must be a directory owned by the current user with mode 0700");
+    }
+    return {};
+}
+
+bool sameUserPeer(int fd) {
+#ifdef SO_PEERCRED
+    ucred credentials {};
+    socklen_t length = sizeof(credentials);
+    return ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) == 0 && credentials.uid == ::getuid();
+#else
+    uid_t uid = 0;
+    gid_t gid = 0;
+    return ::getpeereid(fd, &uid, &gid) == 0 && uid == ::getuid();
+#endif
+}
+#endif
+
+}
+
+struct UploadDaemon::Connection {
+    explicit Connection(int fd) : fd(fd) {}
+    ~Connection() {
+#ifndef _WIN32
+        ::close(fd);
+#endif
+    }
+
+    void send(Json::Value event, const Json::Value& id, std::string_view payload = {}) {
+        event["id"] = id;
+        std::string line = IPFSClient::serializeMetadata(event);
+        line += '\n';
+        std::lock_guard<std::mutex> lock(writeMutex);
+#ifndef _WIN32
+        if (!sendAll(fd, line) || !sendAll(fd, payload)) ::shutdown(fd, SHUT_RDWR);
+#endif
+    }
+
+    int fd;
+    std::mutex writeMutex;
+};
+
+UploadDaemon::UploadDaemon(const Config& config, std::string socketPath, size_t workers)
+    : config(config), path(std::move(socketPath)), workerCount(std::max<size_t>(1, workers)) {}
+
+UploadDaemon::~UploadDaemon() {
+    stop();
+}
+
+std::string UploadDaemon::defaultSocketPath() {
+    if (const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR"); runtimeDir && *runtimeDir) return std::string(runtimeDir) + "/pinatapipe.sock";
+#ifdef _WIN32
+    return "pinatapipe.sock";
+#else
+    return fallbackSocketDirectory() + "/daemon.sock";
+#endif
+}
+
+std::expected<void, std::string> UploadDaemon::start() {
+#ifdef _WIN32
+    return std::unexpected(std::string("Daemon mode is not supported on this platform"));
+#else
+    auto address = socketAddress(path);
+    if (!address) return std::unexpected(address.error());
+    if (std::filesystem::path(path).parent_path() == fallbackSocketDirectory()) {
+        if (auto directory = privateDirectory(fallbackSocketDirectory()); !directory) return std::unexpected(directory.error());
+    }
+    if (int existing = connectTo(*address); existing >= 0) {
+        bool ours = sameUserPeer(existing);
+        ::close(existing);
+        if (!ours) return std::unexpected(path + " is held by a process of another user");
+        return std::unexpected("A daemon is already listening on " + path);
+    }
+    ::unlink(path.c_str());
+
+    try {
+        for (size_t i = 0; i < workerCount; ++i) clients.push_back(std::make_unique<IPFSClient>(config));
+    } catch (const std::exception& e) {
+        clients.clear();
+        return std::unexpected(std::string(e.what()));
+    }
+
+    listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) return std::unexpected(std::string("socket: ") + std::strerror(errno));
+    mode_t previous = ::umask(0177);
+    bool bound = ::bind(listener, reinterpret_cast<const sockaddr*>(&*address), sizeof(*address)) == 0;
+    ::umask(previous);
+    if (!bound || ::listen(listener, 128) != 0) {
+        std::string error = "Could not listen on " + path + ": " + std::strerror(errno);
+        ::close(listener);
+        listener = -1;
+        return std::unexpected(error);
+    }
+
+    running = true;
+    for (auto& client : clients) workers.emplace_back(&UploadDaemon::workLoop, this, std::ref(*client));
+    acceptor = std::thread(&UploadDaemon::acceptLoop, this);
+    Logger::info("Daemon listening on {} with {} workers", path, workerCount);
+    return {};
+#endif
+}
+
+void UploadDaemon::stop() {
+#ifndef _WIN32
+    if (!running.exchange(false)) return;
+    ::shutdown(listener, SHUT_RDWR);
+    ::close(listener);
+    listener = -1;
+    acceptor.join();
+    ::unlink(path.c_str());
+    {
+        std::unique_lock<std::mutex> lock(connectionsMutex);
+        for (auto& weak : connections) {
+            if (auto connection = weak.lock()) ::shutdown(connection->fd, SHUT_RDWR);
+        }
+        readersDone.wait(lock, [this] { return activeReaders == 0; });
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_all();
+    for (auto& worker : workers) worker.join();
+    workers.clear();
+    clients.clear();
+#endif
+}
+
+void UploadDaemon::acceptLoop() {
+#ifndef _WIN32
+    while (running) {
+        int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (!running) return;
+            continue;
+        }
+        auto connection = std::make_shared<Connection>(fd);
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        std::erase_if(connections, [](const std::weak_ptr<Connection>& weak) { return weak.expired(); });
+        connections.push_back(connection);
+        ++activeReaders;
+        std::thread(&UploadDaemon::readLoop, this, std::move(connection)).detach();
+    }
+#endif
+}
+
+void UploadDaemon::readLoop(std::shared_ptr<Connection> connection) {
+#ifndef _WIN32
+    std::string pending;
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    for (;;) {
+        size_t lineEnd = pending.find('\n');
+        if ((lineEnd == std::string::npos ? pending.size() : lineEnd) > MaxRequestLine) {
+            Json::Value event;
+            event["event"] = "error";
+            event["error"] = std::format("Request line is longer than {} bytes", MaxRequestLine);
+            connection->send(event, Json::Value());
+            ::shutdown(connection->fd, SHUT_RDWR);
+            break;
+        }
+        if (lineEnd == std::string::npos) {
+            if (!receiveMore(connection->fd, pending)) break;
+            continue;
+        }
+        Json::Value request;
+        std::string errors;
+        bool parsed = reader->parse(pending.data(), pending.data() + lineEnd, &request, &errors) && request.isObject();
+        pending.erase(0, lineEnd + 1);
+        if (!parsed) {
+            Json::Value event;
+            event["event"] = "error";
+            event["error"] = "Malformed request: " + errors;
+            connection->send(event, Json::Value());
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back({connection, std::move(request)});
+        }
+        queueReady.notify_one();
+    }
+    connection.reset();
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    --activeReaders;
+    readersDone.notify_all();
+#else
+    (void)connection;
+#endif
+}
+
+void UploadDaemon::workLoop(IPFSClient& client) {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        Connection& connection = *job.connection;
+        const Json::Value& request = job.request;
+        const Json::Value& id = request["id"];
+        std::string op = request.get("op", "").asString();
+        auto fail = [&](const std::string& error) {
+            Json::Value event;
+            event["event"] = "error";
+            event["error"] = error;
+            connection.send(event, id);
+        };
+        Logger::debug("Daemon job {}: {}", id.asString(), op);
+
+        if (op == "upload") {
+            std::vector<std::string> files;
+            for (const auto& file : request["files"]) files.push_back(file.asString());
+            if (files.empty()) {
+                fail("upload needs at least one file");
+                continue;
+            }
+            std::optional<Json::Value> metadata;
+            if (request.isMember("metadata")) metadata = request["metadata"];
+            auto strategy = std::make_unique<StreamingUploadStrategy>([&](const std::string& file, const Result<std::string>& result) {
+                Json::Value event;
+                event["file"] = file;
+                if (result) {
+                    event["event"] = "uploaded";
+                    event["cid"] = *result;
+                } else {
+                    event["event"] = "failed";
+                    event["error"] = IPFSClient::errorToString(result.error());
+                }
+                connection.send(event, id);
+            });
+            auto result = client.upload(files, metadata, std::move(strategy));
+            if (!result) {
+                fail(IPFSClient::errorToString(result.error()));
+                continue;
+            }
+        } else if (op == "get") {
+            auto result = client.retrieveContent(request["cid"].asString());
+            if (!result) {
+                fail(IPFSClient::errorToString(result.error()));
+                continue;
+            }
+            Json::Value event;
+            event["event"] = "content";
+            event["bytes"] = Json::UInt64(result->size());
+            connection.send(event, id, *result);
+        } else if (op == "list") {
+            std::optional<std::string> group;
+            if (request.isMember("group")) group = request["group"].asString();
+            auto result = client.listPins(group);
+            if (!result) {
+                fail(IPFSClient::errorToString(result.error()));
+                continue;
+            }
+            Json::Value event;
+            event["event"] = "pins";
+            event["pins"] = *result;
+            connection.send(event, id);
+        } else if (op == "delete") {
+            auto result = client.deletePin(request["cid"].asString());
+            if (!result) {
+                fail(IPFSClient::errorToString(result.error()));
+                continue;
+            }
+        } else if (op != "ping") {
+            fail("Unknown op: " + op);
+            continue;
+        }
+        Json::Value done;
+        done["event"] = "done";
+        connection.send(done, id);
+    }
+}
+
+std::expected<DaemonClient, std::string> DaemonClient::connect(const std::string& socketPath) {
+#ifdef _WIN32
+    return std::unexpected(std::string("Daemon mode is not supported on this platform"));
+#else
+    auto address = socketAddress(socketPath);
+    if (!address) return std::unexpected(address.error());
+    int fd = connectTo(*address);
+    if (fd < 0) return std::unexpected("Could not connect to daemon at " + socketPath + ": " + std::strerror(errno));
+    if (!sameUserPeer(fd)) {
+        ::close(fd);
+        return std::unexpected("Refusing to use " + socketPath + ": it is served by another user");
+    }
+    return DaemonClient(fd);
+#endif
+}
+
+DaemonClient::DaemonClient(DaemonClient&& other) noexcept
+    : fd(std::exchange(other.fd, -1)), nextId(other.nextId), pending(std::move(other.pending)) {}
+
+DaemonClient& DaemonClient::operator=(DaemonClient&& other) noexcept {
+    if (this != &other) {
+#ifndef _WIN32
+        if (fd >= 0) ::close(fd);
+#endif
+        fd = std::exchange(other.fd, -1);
+        nextId = other.nextId;
+        pending = std::move(other.pending);
+    }
+    return *this;
+}
+
+DaemonClient::~DaemonClient() {
+#ifndef _WIN32
+    if (fd >= 0) ::close(fd);
+#endif
+}
+
+std::expected<void, std::string> DaemonClient::request(Json::Value job, const EventHandler& onEvent) {
+#ifdef _WIN32
+    (void)job;
+    (void)onEvent;
+    return std::unexpected(std::string("Daemon mode is not supported on this platform"));
+#else
+    uint64_t id = nextId++;
+    job["id"] = Json::UInt64(id);
+    std::string line = IPFSClient::serializeMetadata(job);
+    line += '\n';
+    if (!sendAll(fd, line)) return std::unexpected(std::string("Lost connection to daemon: ") + std::strerror(errno));
+
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    for (;;) {
+        size_t lineEnd;
+        while ((lineEnd = pending.find('\n')) == std::string::npos) {
+            if (!receiveMore(fd, pending)) return std::unexpected(std::string("Daemon closed the connection"));
+        }
+        Json::Value event;
+        std::string errors;
+        if (!reader->parse(pending.data(), pending.data() + lineEnd, &event, &errors)) return std::unexpected("Malformed daemon response: " + errors);
+        pending.erase(0, lineEnd + 1);
+
+        std::string type = event["event"].asString();
+        size_t payloadSize = type == "content" ? static_cast<size_t>(event["bytes"].asUInt64()) : 0;
+        while (pending.size() < payloadSize) {
+            if (!receiveMore(fd, pending)) return std::unexpected(std::string("Daemon closed the connection"));
+        }
+        std::string payload = pending.substr(0, payloadSize);
+        pending.erase(0, payloadSize);
+
+        if (event["id"].asUInt64() != id) continue;
+        if (type == "error") return std::unexpected(event["error"].asString());
+        if (type == "done") return {};
+        onEvent(event, payload);
+    }
+#endif
+}
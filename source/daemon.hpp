@@ -0,0 +1,90 @@
+#ifndef DAEMON_HPP
+#define DAEMON_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <json/json.h>
+#include "config.hpp"
+
+class IPFSClient;
+
+class UploadDaemon {
+public:
+    static constexpr size_t DefaultWorkers = 4;
+    static constexpr size_t MaxRequestLine = 1024 * 1024;
+
+    UploadDaemon(const Config& config, std::string socketPath, size_t workers = DefaultWorkers);
+    UploadDaemon(const UploadDaemon&) = delete;
+    UploadDaemon& operator=(const UploadDaemon&) = delete;
+    ~UploadDaemon();
+
+    std::expected<void, std::string> start();
+    void stop();
+    const std::string& socketPath() const { return path; }
+
+    static std::string defaultSocketPath();
+
+private:
+    struct Connection;
+    struct Job {
+        std::shared_ptr<Connection> connection;
+        Json::Value request;
+    };
+
+    void acceptLoop();
+    void readLoop(std::shared_ptr<Connection> connection);
+    void workLoop(IPFSClient& client);
+
+    Config config;
+    std::string path;
+    size_t workerCount;
+    int listener = -1;
+    std::atomic<bool> running{false};
+    std::thread acceptor;
+    std::vector<std::unique_ptr<IPFSClient>> clients;
+    std::vector<std::thread> workers;
+
+    std::mutex connectionsMutex;
+    std::condition_variable readersDone;
+    std::vector<std::weak_ptr<Connection>> connections;
+    size_t activeReaders = 0;
+
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<Job> queue;
+    bool stopping = false;
+};
+
+class DaemonClient {
+public:
+    using EventHandler = std::function<void(const Json::Value& event, std::string_view payload)>;
+
+    static std::expected<DaemonClient, std::string> connect(const std::string& socketPath);
+
+    DaemonClient(DaemonClient&& other) noexcept;
+    DaemonClient& operator=(DaemonClient&& other) noexcept;
+    DaemonClient(const DaemonClient&) = delete;
+    DaemonClient& operator=(const DaemonClient&) = delete;
+    ~DaemonClient();
+
+    std::expected<void, std::string> request(Json::Value job, const EventHandler& onEvent);
+
+private:
+    explicit DaemonClient(int fd) : fd(fd) {}
+
+    int fd = -1;
+    uint64_t nextId = 1;
+    std::string pending;
+};
+
+#endif
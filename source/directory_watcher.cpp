@@ -0,0 +1,293 @@
+#include "directory_watcher.hpp"
+#include "logger.hpp"
+#include "private_file.hpp"
+#include "sha256.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::chrono::seconds FailureRetryDelay{30};
+
+#ifdef __linux__
+constexpr uint32_t WatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ONLYDIR;
+#endif
+
+std::filesystem::path watchRoot(const std::filesystem::path& root) {
+    std::filesystem::path normalized = std::filesystem::absolute(root).lexically_normal();
+    if (normalized.has_relative_path() && !normalized.has_filename()) normalized = normalized.parent_path();
+    return normalized;
+}
+
+}
+
+DirectoryWatcher::DirectoryWatcher(IPFSClient& client, std::filesystem::path root, WatchOptions options)
+    : client(client), root(watchRoot(root)), options(std::move(options)),
+      scope(SyncManifest::scope(client.accountDigest(), this->options.metadata ? IPFSClient::serializeMetadata(*this->options.metadata) : "")),
+      manifest(this->options.manifestPath.empty() ? defaultManifestPath(this->root, scope) : this->options.manifestPath, scope) {}
+
+DirectoryWatcher::~DirectoryWatcher() {
+#ifdef __linux__
+    if (fd >= 0) ::close(fd);
+#endif
+}
+
+std::filesystem::path DirectoryWatcher::defaultManifestPath(const std::filesystem::path& root, std::string_view scope) {
+    std::string key = watchRoot(root).string();
+    key.append(1, '\0').append(scope);
+    return userCacheDirectory() / "watch" / (Sha256::hex(key).substr(0, 16) + ".manifest");
+}
+
+std::optional<std::string> DirectoryWatcher::cid(const std::string& path) const {
+    const ManifestEntry* entry = manifest.find(path);
+    if (!entry) return std::nullopt;
+    return entry->cid;
+}
+
+std::expected<void, std::string> DirectoryWatcher::start() {
+#ifdef __linux__
+    std::error_code ec;
+    if (!std::filesystem::is_directory(root, ec)) return std::unexpected(root.string() + " is not a directory");
+    fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return std::unexpected(std::string("Could not initialize inotify: ") + std::strerror(errno));
+
+    if (auto opened = manifest.open(); !opened) return std::unexpected(opened.error());
+    fullScan();
+    if (auto flushed = manifest.flush(); !flushed) return std::unexpected(flushed.error());
+    Logger::info("Watching {} ({} directories, {} known files, {} to upload)", root.string(), watches.size(), manifest.size(), pending.size());
+    return {};
+#else
+    return std::unexpected("Watch mode needs inotify, which is only available on Linux");
+#endif
+}
+
+bool DirectoryWatcher::ignored(const std::string& path) const {
+    return path.starts_with(manifest.location().string());
+}
+
+void DirectoryWatcher::addWatch(const std::string& directory) {
+#ifdef __linux__
+    int wd = ::inotify_add_watch(fd, directory.c_str(), WatchMask);
+    if (wd >= 0) {
+        watches[wd] = directory;
+        return;
+    }
+    if (errno == ENOSPC) Logger::warn("Could not watch {}: inotify watch limit reached (raise fs.inotify.max_user_watches)", directory);
+    else Logger::warn("Could not watch {}: {}", directory, std::strerror(errno));
+#else
+    (void)directory;
+#endif
+}
+
+void DirectoryWatcher::scan(const std::string& directory, std::unordered_set<std::string>* seen) {
+#ifdef __linux__
+    addWatch(directory);
+    std::error_code ec;
+    auto iteration = std::filesystem::directory_options::skip_permission_denied;
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, iteration, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        std::string path = it->path().string();
+        if (it->is_symlink(ec)) continue;
+        if (it->is_directory(ec)) {
+            addWatch(path);
+            continue;
+        }
+        if (ignored(path)) continue;
+        auto identity = SyncManifest::identify(path);
+        if (!identity) continue;
+        if (seen) seen->insert(path);
+        if (!manifest.unchangedCid(path, *identity)) pending.try_emplace(path);
+    }
+#else
+    (void)directory;
+    (void)seen;
+#endif
+}
+
+void DirectoryWatcher::fullScan() {
+    std::unordered_set<std::string> seen;
+    scan(root.string(), &seen);
+    std::string prefix = root.string() + "/";
+    manifest.removeIf([&](const std::string& path) { return path.starts_with(prefix) && !seen.contains(path); });
+}
+
+void DirectoryWatcher::forgetDirectory(const std::string& directory, uint32_t cookie) {
+#ifdef __linux__
+    std::string prefix = directory + "/";
+    for (auto it = watches.begin(); it != watches.end();) {
+        if (it->second == directory || it->second.starts_with(prefix)) {
+            ::inotify_rm_watch(fd, it->first);
+            it = watches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    auto& moved = movedAway[cookie].entries;
+    manifest.removeIf([&](const std::string& path) {
+        if (!path.starts_with(prefix)) return false;
+        moved.emplace_back(path.substr(directory.size()), *manifest.find(path));
+        return true;
+    });
+    std::erase_if(pending, [&](const auto& entry) { return entry.first.starts_with(prefix); });
+#else
+    (void)directory;
+    (void)cookie;
+#endif
+}
+
+void DirectoryWatcher::readEvents() {
+#ifdef __linux__
+    alignas(inotify_event) char buffer[64 * 1024];
+    for (;;) {
+        ssize_t length = ::read(fd, buffer, sizeof(buffer));
+        if (length < 0 && errno == EINTR) continue;
+        if (length <= 0) return;
+        auto now = std::chrono::steady_clock::now();
+        for (char* cursor = buffer; cursor < buffer + length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(cursor);
+            cursor += sizeof(inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                rescanRequested = true;
+                continue;
+            }
+            auto watch = watches.find(event->wd);
+            if (watch == watches.end()) continue;
+            if (event->mask & IN_IGNORED) {
+                watches.erase(watch);
+                continue;
+            }
+            if (event->len == 0) continue;
+            std::string path = watch->second + "/" + event->name;
+            if (ignored(path)) continue;
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & IN_MOVED_TO) renamed(path, event->cookie);
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) scan(path);
+                else if (event->mask & IN_MOVED_FROM) forgetDirectory(path, event->cookie);
+            } else if (event->mask & IN_MOVED_TO && renamed(path, event->cookie)) {
+                continue;
+            } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                pending[path] = now;
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                pending.erase(path);
+                if (const ManifestEntry* entry = manifest.find(path); entry && event->mask & IN_MOVED_FROM) movedAway[event->cookie].entries.emplace_back("", *entry);
+                manifest.remove(path);
+            }
+        }
+    }
+#endif
+}
+
+bool DirectoryWatcher::renamed(const std::string& path, uint32_t cookie) {
+    auto moved = movedAway.find(cookie);
+    if (moved == movedAway.end()) return false;
+    size_t restored = 0;
+    for (auto& [suffix, entry] : moved->second.entries) {
+        std::string target = path + suffix;
+        auto identity = SyncManifest::identify(target);
+        if (!identity || *identity != entry.identity) continue;
+        Logger::debug("{} was renamed, keeping {}", target, entry.cid);
+        pending.erase(target);
+        manifest.record(target, *identity, std::move(entry.cid));
+        ++restored;
+    }
+    movedAway.erase(moved);
+    counters.filesRenamed += restored;
+    return restored > 0;
+}
+
+void DirectoryWatcher::expireMoves() {
+    auto cutoff = std::chrono::steady_clock::now() - IdlePoll;
+    std::erase_if(movedAway, [&](const auto& moved) { return moved.second.at < cutoff; });
+}
+
+std::chrono::milliseconds DirectoryWatcher::nextTimeout() const {
+    auto now = std::chrono::steady_clock::now();
+    auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(IdlePoll);
+    for (const auto& [path, lastEvent] : pending) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(lastEvent + options.debounce - now);
+        timeout = std::min(timeout, std::max(remaining, std::chrono::milliseconds(0)));
+    }
+    return timeout;
+}
+
+void DirectoryWatcher::uploadReady(const StreamingUploadStrategy::FileHandler& onFile) {
+#ifdef __linux__
+    auto now = std::chrono::steady_clock::now();
+    std::vector<std::string> ready;
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (now - it->second < options.debounce) {
+            ++it;
+            continue;
+        }
+        ready.push_back(it->first);
+        it = pending.erase(it);
+    }
+    if (ready.empty()) return;
+    ++counters.cycles;
+
+    std::unordered_map<std::string, FileIdentity> changed;
+    std::vector<std::string> uploads;
+    for (auto& path : ready) {
+        auto identity = SyncManifest::identify(path);
+        if (!identity) continue;
+        if (manifest.unchangedCid(path, *identity)) {
+            ++counters.filesUnchanged;
+            continue;
+        }
+        changed.emplace(path, *identity);
+        uploads.push_back(std::move(path));
+    }
+    if (uploads.empty()) return;
+    std::ranges::sort(uploads);
+
+    Logger::debug("Uploading {} changed files from {}", uploads.size(), root.string());
+    auto strategy = std::make_unique<StreamingUploadStrategy>([&](const std::string& file, const Result<std::string>& result) {
+        if (result) {
+            manifest.record(file, changed[file], *result);
+            ++counters.filesUploaded;
+        } else {
+            pending[file] = std::chrono::steady_clock::now() + FailureRetryDelay;
+            ++counters.filesFailed;
+        }
+        onFile(file, result);
+    });
+    client.upload(uploads, options.metadata, std::move(strategy));
+    if (auto flushed = manifest.flush(); !flushed) Logger::warn("{}", flushed.error());
+#else
+    (void)onFile;
+#endif
+}
+
+void DirectoryWatcher::run(const std::function<bool()>& stopRequested, const StreamingUploadStrategy::FileHandler& onFile) {
+#ifdef __linux__
+    uploadReady(onFile);
+    while (!stopRequested()) {
+        pollfd descriptor{fd, POLLIN, 0};
+        int ready = ::poll(&descriptor, 1, static_cast<int>(nextTimeout().count()));
+        if (ready < 0 && errno != EINTR) {
+            Logger::error("Polling inotify failed: {}", std::strerror(errno));
+            return;
+        }
+        if (ready > 0) readEvents();
+        expireMoves();
+        if (rescanRequested) {
+            Logger::warn("inotify queue overflowed, rescanning {}", root.string());
+            rescanRequested = false;
+            ++counters.rescans;
+            fullScan();
+        }
+        uploadReady(onFile);
+    }
+#else
+    (void)stopRequested;
+    (void)onFile;
+#endif
+}
@@ -0,0 +1,81 @@
+#ifndef DIRECTORY_WATCHER_HPP
+#define DIRECTORY_WATCHER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <json/json.h>
+#include "ipfs_client.hpp"
+#include "sync_manifest.hpp"
+
+struct WatchOptions {
+    std::chrono::milliseconds debounce{500};
+    std::filesystem::path manifestPath;
+    std::optional<Json::Value> metadata;
+};
+
+struct WatchStats {
+    uint64_t cycles = 0;
+    uint64_t filesUploaded = 0;
+    uint64_t filesFailed = 0;
+    uint64_t filesUnchanged = 0;
+    uint64_t filesRenamed = 0;
+    uint64_t rescans = 0;
+};
+
+class DirectoryWatcher {
+public:
+    static constexpr std::chrono::milliseconds IdlePoll{250};
+
+    DirectoryWatcher(IPFSClient& client, std::filesystem::path root, WatchOptions options);
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+    ~DirectoryWatcher();
+
+    std::expected<void, std::string> start();
+    void run(const std::function<bool()>& stopRequested, const StreamingUploadStrategy::FileHandler& onFile);
+    std::optional<std::string> cid(const std::string& path) const;
+    const WatchStats& stats() const { return counters; }
+
+    static std::filesystem::path defaultManifestPath(const std::filesystem::path& root, std::string_view scope);
+
+private:
+    struct MovedAway {
+        std::chrono::steady_clock::time_point at = std::chrono::steady_clock::now();
+        std::vector<std::pair<std::string, ManifestEntry>> entries;
+    };
+
+    bool ignored(const std::string& path) const;
+    void addWatch(const std::string& directory);
+    void scan(const std::string& directory, std::unordered_set<std::string>* seen = nullptr);
+    void fullScan();
+    void forgetDirectory(const std::string& directory, uint32_t cookie);
+    void readEvents();
+    bool renamed(const std::string& path, uint32_t cookie);
+    void expireMoves();
+    void uploadReady(const StreamingUploadStrategy::FileHandler& onFile);
+    std::chrono::milliseconds nextTimeout() const;
+
+    IPFSClient& client;
+    std::filesystem::path root;
+    WatchOptions options;
+    std::string scope;
+    int fd = -1;
+    std::unordered_map<int, std::string> watches;
+    SyncManifest manifest;
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> pending;
+    std::unordered_map<uint32_t, MovedAway> movedAway;
+    bool rescanRequested = false;
+    WatchStats counters;
+};
+
+#endif
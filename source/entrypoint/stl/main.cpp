@@ -1,115 +1,507 @@
 #include "ipfs_client.hpp"
+#include "batch_journal.hpp"
+#include "daemon.hpp"
+#include "directory_watcher.hpp"
+#include "event_log.hpp"
+#include "load_generator.hpp"
+#include "metrics_exporter.hpp"
+#include "request_recorder.hpp"
+#include "sync_manifest.hpp"
+#include "trace.hpp"
 #include <iostream>
 #include <vector>
+#include <array>
 #include <iomanip>
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
 
 void printUsage() {
     std::cout << "Usage: IPFSTool <command> [arguments] [--verbose]\n";
     std::cout << "Commands:\n";
     std::cout << "  upload <file_path> [--group <group_name>] [--metadata <json>]\n";
-    std::cout << "  batch <file1> <file2> ... [--group <group_name>] [--metadata <json>]\n";
+    std::cout << "  batch <file|dir> ... [--group <group_name>] [--metadata <json>] [--incremental] [--manifest <file>] [--journal <file>]\n";
+    std::cout << "  batch --resume <journal> [--incremental] [--manifest <file>]\n";
     std::cout << "  get <ipfs_hash>\n";
     std::cout << "  list [--group <group_name>]\n";
     std::cout << "  delete <ipfs_hash>\n";
+    std::cout << "  watch <dir> [--debounce-ms <n>] [--manifest <file>] [--group <group_name>] [--metadata <json>]\n";
+    std::cout << "  daemon [--workers <n>]\n";
+    std::cout << "  bench [--workload <small|lognormal|huge>] [--files <n>] [--concurrency <n,n,...>] [--huge-mb <n>] [--seed <n>] [--dir <path>] [--keep-files]\n";
     std::cout << "Options:\n";
     std::cout << "  --verbose  Enable detailed output\n";
     std::cout << "  --group    Assign a group name to uploaded files\n";
+    std::cout << "  --bulk     Drop uploaded file pages from the page cache as they are sent\n";
+    std::cout << "  --direct-io  With --bulk, read files with O_DIRECT where supported\n";
+    std::cout << "  --log-overflow <drop|block>  What to do when the log queue is full (default: block)\n";
+    std::cout << "  --log-level <trace|debug|info|warn|error>  Minimum level printed with --verbose (default: debug)\n";
+    std::cout << "  --api-url <url>      Pinata API base URL (default: https://api.pinata.cloud/)\n";
+    std::cout << "  --gateway-url <url>  IPFS gateway base URL used by get (default: https://ipfs.io/ipfs/)\n";
+    std::cout << "  --via-daemon     Send the command to a running daemon instead of executing it in this process\n";
+    std::cout << "  --socket <path>  Daemon socket (default: $XDG_RUNTIME_DIR/pinatapipe.sock or /tmp/pinatapipe-<uid>/daemon.sock)\n";
+    std::cout << "  --key-validation <eager|lazy|cached|async>  When to check API keys against testAuthentication (default: eager)\n";
+    std::cout << "  --prewarm  Open connections to the API and gateway hosts in the background while the command starts\n";
+    std::cout << "  --connection-cache  Reuse resolved addresses and TLS sessions from earlier runs\n";
+    std::cout << "  --connection-cache-file <path>  Where --connection-cache keeps them (default: ~/.cache/pinatapipe/connections)\n";
+    std::cout << "  --stats    Print per-endpoint latency percentiles on exit\n";
+    std::cout << "  --metrics-file <path>  Periodically write OpenMetrics text to <path> (for node-exporter's textfile collector)\n";
+    std::cout << "  --metrics-interval <seconds>  How often to rewrite the metrics file (default: 15)\n";
+    std::cout << "  --trace <file>  Write a Chrome trace-event timeline (open in Perfetto or chrome://tracing)\n";
+    std::cout << "  --record <file>  Record per-request timing, sizes and status (no bodies, URLs or keys) to a binary trace for replay\n";
+    std::cout << "  --events <file>  Append one JSON object per request/upload event to <file> (- for stdout)\n";
 }
 
-int main(int argc, char* argv[]) {
-    CURLcode globalInitResult = curl_global_init(CURL_GLOBAL_ALL);
-    if (globalInitResult != CURLE_OK) {
-        std::cerr << "Failed to initialize CURL globally: " << curl_easy_strerror(globalInitResult) << "\n";
+void renderProgress(const ProgressSnapshot& progress, bool final) {
+    constexpr int barWidth = 20;
+    double percent = progress.bytesTotal > 0 ? 100.0 * static_cast<double>(progress.bytesSent) / static_cast<double>(progress.bytesTotal) : 0.0;
+    int pos = static_cast<int>(percent * barWidth / 100.0);
+    Logger::flush();
+    std::cerr << "\r\033[33m[PROGRESS]\033[0m [";
+    for (int i = 0; i < barWidth; ++i) std::cerr << (i < pos ? '#' : ' ');
+    std::cerr << "] " << std::fixed << std::setprecision(1) << percent << "% | "
+              << static_cast<double>(progress.bytesSent) / (1024 * 1024) << "/" << static_cast<double>(progress.bytesTotal) / (1024 * 1024) << " MB | "
+              << progress.bytesPerSecond / (1024 * 1024) << " MB/s | "
+              << "files " << progress.filesDone << "/" << progress.filesTotal;
+    if (progress.filesFailed > 0) std::cerr << " (" << progress.filesFailed << " failed)";
+    std::cerr << " | ETA: " << progress.etaSeconds << "s\033[K" << std::flush;
+    if (final) std::cerr << "\n";
+}
+
+std::vector<size_t> parseConcurrency(const std::string& list) {
+    std::vector<size_t> levels;
+    std::stringstream stream(list);
+    std::string level;
+    while (std::getline(stream, level, ',')) {
+        if (long value = std::atol(level.c_str()); value > 0) levels.push_back(static_cast<size_t>(value));
+    }
+    return levels;
+}
+
+void printLoadResults(const LoadGenerator& generator, Workload workload, const std::vector<LoadResult>& results) {
+    std::cout << "workload " << LoadGenerator::workloadName(workload) << ": " << generator.files().size() << " files, "
+              << std::fixed << std::setprecision(1) << static_cast<double>(generator.totalBytes()) / (1024 * 1024) << " MB\n";
+    std::cout << std::right << std::setw(6) << "conc" << std::setw(8) << "ok" << std::setw(8) << "failed" << std::setw(10) << "files/s" << std::setw(10) << "MB/s"
+              << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "max ms" << std::setw(10) << "CPU s/GB" << "\n";
+    for (const auto& result : results) {
+        std::cout << std::setw(6) << result.concurrency << std::setw(8) << result.filesUploaded << std::setw(8) << result.filesFailed << std::fixed << std::setprecision(1)
+                  << std::setw(10) << result.filesPerSecond() << std::setw(10) << result.megabytesPerSecond() << std::setprecision(2);
+        for (double percentile : {50.0, 90.0, 99.0}) std::cout << std::setw(10) << result.latency.percentileUs(percentile) / 1000.0;
+        std::cout << std::setw(10) << result.latency.maxUs / 1000.0 << std::setw(10) << result.cpuSecondsPerGigabyte() << "\n";
+    }
+}
+
+void printLatencyHeader(std::string_view label) {
+    std::cerr << std::left << std::setw(20) << label << std::setw(7) << "phase" << std::right << std::setw(8) << "count"
+              << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "p99.9 ms" << std::setw(10) << "max ms" << "\n";
+}
+
+void printLatencyRow(std::string_view name, std::string_view phase, const LatencySnapshot& snapshot) {
+    std::cerr << std::left << std::setw(20) << name << std::setw(7) << phase << std::right << std::setw(8) << snapshot.count << std::fixed << std::setprecision(2);
+    for (double percentile : {50.0, 90.0, 99.0, 99.9}) std::cerr << std::setw(10) << snapshot.percentileUs(percentile) / 1000.0;
+    std::cerr << std::setw(10) << snapshot.maxUs / 1000.0 << "\n";
+}
+
+void printLatencyStats(const IPFSClient& client) {
+    constexpr std::array<std::pair<LatencyPhase, const char*>, 2> phases{{{LatencyPhase::TimeToFirstByte, "ttfb"}, {LatencyPhase::Total, "total"}}};
+    printLatencyHeader("endpoint");
+    for (size_t i = 0; i < IPFSClient::EndpointCount; ++i) {
+        auto endpoint = static_cast<Endpoint>(i);
+        for (const auto& [phase, phaseName] : phases) {
+            LatencySnapshot snapshot = client.latency(endpoint, phase);
+            if (snapshot.count > 0) printLatencyRow(IPFSClient::endpointName(endpoint), phaseName, snapshot);
+        }
+    }
+    if (uint64_t bypassed = client.stats().cacheBypassedBytes) std::cerr << "page cache bypassed: " << bypassed << " bytes\n";
+}
+
+struct UploadArgs {
+    std::vector<std::string> files;
+    std::optional<Json::Value> metadata;
+    bool incremental = false;
+    std::string manifestPath;
+    std::string journalPath;
+    std::string resumePath;
+};
+
+void addBatchPath(std::vector<std::string>& files, const std::string& path) {
+    std::error_code ec;
+    if (!fs::is_directory(path, ec)) {
+        files.push_back(path);
+        return;
+    }
+    size_t first = files.size();
+    auto options = fs::directory_options::skip_permission_denied;
+    for (auto it = fs::recursive_directory_iterator(path, options, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_regular_file(ec)) files.push_back(it->path().string());
+    }
+    std::sort(files.begin() + static_cast<std::ptrdiff_t>(first), files.end());
+}
+
+UploadArgs parseUploadArgs(const std::vector<std::string>& args, bool batch) {
+    UploadArgs upload;
+    size_t i = 2;
+    if (batch) {
+        while (i < args.size() && args[i].substr(0, 2) != "--") addBatchPath(upload.files, args[i++]);
+    } else {
+        upload.files.push_back(args[i++]);
+    }
+    std::optional<std::string> group;
+    for (; i < args.size(); ++i) {
+        bool hasValue = i + 1 < args.size();
+        if (args[i] == "--incremental") upload.incremental = true;
+        else if (args[i] == "--group" && hasValue) group = args[++i];
+        else if (args[i] == "--manifest" && hasValue) upload.manifestPath = args[++i];
+        else if (args[i] == "--journal" && hasValue) upload.journalPath = args[++i];
+        else if (args[i] == "--resume" && hasValue) upload.resumePath = args[++i];
+        else if (args[i] == "--metadata" && hasValue) {
+            auto json = IPFSClient::parseJSON(args[++i]);
+            if (!json) throw std::runtime_error(IPFSClient::errorToString(json.error()));
+            upload.metadata = *json;
+        }
+    }
+    if (group) {
+        if (!upload.metadata) upload.metadata = Json::Value(Json::objectValue);
+        (*upload.metadata)["name"] = *group;
+    }
+    return upload;
+}
+
+void runBatch(IPFSClient& client, UploadArgs upload) {
+    std::optional<BatchJournal> journal;
+    if (!upload.resumePath.empty()) {
+        if (!upload.files.empty()) throw std::runtime_error("--resume takes the files from the journal, do not list them again");
+        auto resumed = BatchJournal::resume(upload.resumePath);
+        if (!resumed) throw std::runtime_error(resumed.error());
+        journal.emplace(std::move(*resumed));
+        upload.files = journal->remaining();
+        upload.metadata = journal->metadata();
+        Logger::info("Resuming {}: {} of {} files already uploaded, {} left ({} failed last time)", upload.resumePath, journal->uploaded().size(), journal->files().size(),
+                     upload.files.size(), journal->failed().size());
+    } else if (!upload.journalPath.empty()) {
+        auto created = BatchJournal::create(upload.journalPath, upload.files, upload.metadata);
+        if (!created) throw std::runtime_error(created.error());
+        journal.emplace(std::move(*created));
+        upload.files = journal->files();
+    }
+
+    std::optional<SyncManifest> manifest;
+    std::unordered_map<std::string, FileIdentity> changedIdentities;
+    std::vector<std::string> changed;
+    if (upload.incremental) {
+        std::string scope = SyncManifest::scope(client.accountDigest(), upload.metadata ? IPFSClient::serializeMetadata(*upload.metadata) : "");
+        manifest.emplace(upload.manifestPath.empty() ? SyncManifest::defaultPath(scope) : fs::path(upload.manifestPath), scope);
+        if (auto opened = manifest->open(); !opened) throw std::runtime_error(opened.error());
+        fs::path cwd = fs::current_path();
+        std::vector<std::string> paths;
+        paths.reserve(upload.files.size());
+        for (const auto& file : upload.files) paths.push_back((cwd / file).lexically_normal().string());
+        auto identities = SyncManifest::identifyAll(paths);
+        size_t unchanged = 0;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            if (identities[i]) {
+                if (auto cid = manifest->unchangedCid(paths[i], *identities[i])) {
+                    std::cout << "Unchanged: " << *cid << "\n";
+                    if (journal) journal->record(paths[i], *cid);
+                    ++unchanged;
+                    continue;
+                }
+                changedIdentities.emplace(paths[i], *identities[i]);
+            }
+            changed.push_back(paths[i]);
+        }
+        Logger::info("{} of {} files unchanged since the last run, uploading {}", unchanged, paths.size(), changed.size());
+    } else {
+        changed = std::move(upload.files);
+    }
+    if (changed.empty()) return;
+
+    auto strategy = std::make_unique<StreamingUploadStrategy>([&](const std::string& file, const Result<std::string>& result) {
+        if (journal) journal->record(file, result);
+        if (!result) {
+            Logger::error("Failed to upload {}: {}", file, IPFSClient::errorToString(result.error()));
+            return;
+        }
+        std::cout << "Uploaded: " << *result << "\n";
+        if (auto identity = changedIdentities.find(file); manifest && identity != changedIdentities.end()) manifest->record(file, identity->second, *result);
+    });
+    auto result = client.upload(changed, upload.metadata, std::move(strategy));
+    if (!result) throw std::runtime_error(client.errorToString(result.error()));
+}
+
+int forwardToDaemon(const std::vector<std::string>& args, const std::string& socketPath) {
+    const std::string& command = args[1];
+    bool hasTarget = args.size() >= 3 && args[2].substr(0, 2) != "--";
+    try {
+        Json::Value job(Json::objectValue);
+        if ((command == "upload" || command == "batch") && args.size() >= 3) {
+            UploadArgs upload = parseUploadArgs(args, command == "batch");
+            if (upload.incremental || !upload.journalPath.empty() || !upload.resumePath.empty()) {
+                throw std::runtime_error("--incremental, --journal and --resume are not supported with --via-daemon");
+            }
+            job["op"] = "upload";
+            job["files"] = Json::Value(Json::arrayValue);
+            for (const auto& file : upload.files) job["files"].append(fs::absolute(file).string());
+            if (upload.metadata) job["metadata"] = *upload.metadata;
+        } else if ((command == "get" || command == "delete") && hasTarget) {
+            job["op"] = command;
+            job["cid"] = args[2];
+        } else if (command == "list") {
+            job["op"] = "list";
+            if (args.size() > 3 && args[2] == "--group") job["group"] = args[3];
+        } else {
+            printUsage();
+            return 1;
+        }
+
+        auto daemon = DaemonClient::connect(socketPath);
+        if (!daemon) throw std::runtime_error(daemon.error());
+        std::optional<std::string> failure;
+        auto result = daemon->request(job, [&](const Json::Value& event, std::string_view payload) {
+            std::string type = event["event"].asString();
+            if (type == "uploaded") std::cout << "Uploaded: " << event["cid"].asString() << "\n";
+            else if (type == "failed") {
+                Logger::error("Failed to upload {}: {}", event["file"].asString(), event["error"].asString());
+                if (!failure) failure = event["error"].asString();
+            }
+            else if (type == "content") std::cout << "Content:\n" << payload << "\n";
+            else if (type == "pins") {
+                Json::StreamWriterBuilder writer;
+                std::cout << "Pinned Files:\n" << Json::writeString(writer, event["pins"]) << "\n";
+            }
+        });
+        if (!result) throw std::runtime_error(result.error());
+        if (command == "upload" && failure) throw std::runtime_error(*failure);
+        if (command == "delete") std::cout << "Deleted pin: " + args[2] << "\n";
+    } catch (const std::exception& e) {
+        Logger::flush();
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void runBench(const Config& config, const std::vector<std::string>& args, bool showStats) {
+    LoadOptions options;
+    for (size_t i = 2; i < args.size(); ++i) {
+        bool hasValue = i + 1 < args.size();
+        if (args[i] == "--keep-files") options.keepFiles = true;
+        else if (args[i] == "--workload" && hasValue) {
+            auto workload = LoadGenerator::parseWorkload(args[++i]);
+            if (!workload) throw std::runtime_error("Unknown workload: " + args[i]);
+            options.workload = *workload;
+        }
+        else if (args[i] == "--files" && hasValue) options.fileCount = static_cast<size_t>(std::max(1L, std::atol(args[++i].c_str())));
+        else if (args[i] == "--concurrency" && hasValue) options.concurrency = parseConcurrency(args[++i]);
+        else if (args[i] == "--huge-mb" && hasValue) options.hugeBytes = static_cast<uint64_t>(std::max(1L, std::atol(args[++i].c_str()))) * 1024 * 1024;
+        else if (args[i] == "--seed" && hasValue) options.seed = std::strtoull(args[++i].c_str(), nullptr, 10);
+        else if (args[i] == "--dir" && hasValue) options.directory = args[++i];
+    }
+    if (options.concurrency.empty()) throw std::runtime_error("--concurrency needs at least one positive level");
+    Workload workload = options.workload;
+    std::vector<size_t> levels = options.concurrency;
+    LoadGenerator generator(config, std::move(options));
+    if (auto prepared = generator.prepare(); !prepared) throw std::runtime_error(prepared.error());
+    if (Logger::verboseMode) Progress::start(renderProgress);
+    std::vector<LoadResult> results;
+    for (size_t level : levels) results.push_back(generator.run(level));
+    Progress::stop();
+    printLoadResults(generator, workload, results);
+    if (!showStats) return;
+    printLatencyHeader("concurrency");
+    for (const auto& result : results) printLatencyRow(std::to_string(result.concurrency), "upload", result.latency);
+}
+
+int runDaemon(const Config& config, const std::vector<std::string>& args, const std::string& socketPath) {
+    size_t workers = UploadDaemon::DefaultWorkers;
+    for (size_t i = 2; i + 1 < args.size(); i += 2) {
+        if (args[i] == "--workers") workers = static_cast<size_t>(std::max(1L, std::atol(args[i + 1].c_str())));
+    }
+    UploadDaemon daemon(config, socketPath, workers);
+    auto started = daemon.start();
+    if (!started) {
+        std::cerr << "Error: " << started.error() << "\n";
         return 1;
     }
+    std::cout << "Daemon listening on " << daemon.socketPath() << std::endl;
+    std::signal(SIGINT, [](int) { stopRequested = 1; });
+    std::signal(SIGTERM, [](int) { stopRequested = 1; });
+    while (!stopRequested) std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    daemon.stop();
+    return 0;
+}
+
+void runWatch(IPFSClient& client, const std::vector<std::string>& args) {
+    UploadArgs upload = parseUploadArgs(args, false);
+    WatchOptions options;
+    options.metadata = upload.metadata;
+    options.manifestPath = upload.manifestPath;
+    for (size_t i = 3; i + 1 < args.size(); ++i) {
+        if (args[i] == "--debounce-ms") options.debounce = std::chrono::milliseconds(std::max(0L, std::atol(args[++i].c_str())));
+    }
+    DirectoryWatcher watcher(client, upload.files[0], std::move(options));
+    if (auto started = watcher.start(); !started) throw std::runtime_error(started.error());
+    std::signal(SIGINT, [](int) { stopRequested = 1; });
+    std::signal(SIGTERM, [](int) { stopRequested = 1; });
+    watcher.run([] { return stopRequested != 0; }, [](const std::string& file, const Result<std::string>& result) {
+        if (result) std::cout << "Uploaded: " << file << " " << *result << std::endl;
+        else Logger::error("Failed to upload {}: {}", file, IPFSClient::errorToString(result.error()));
+    });
+    const WatchStats& stats = watcher.stats();
+    Logger::info("Watch stopped after {} cycles: {} uploaded, {} failed, {} unchanged, {} renamed, {} rescans", stats.cycles, stats.filesUploaded, stats.filesFailed,
+                 stats.filesUnchanged, stats.filesRenamed, stats.rescans);
+}
+
+int main(int argc, char* argv[]) {
+    bool bulk = false;
+    bool directIO = false;
+    bool showStats = false;
+    bool prewarm = false;
+    bool connectionCache = false;
+    std::string connectionCacheFile;
+    std::string metricsFile;
+    std::optional<std::string> apiUrl;
+    std::optional<std::string> gatewayUrl;
+    long metricsInterval = MetricsExporter::DefaultInterval.count();
+    bool viaDaemon = false;
+    std::optional<KeyValidation> keyValidation;
+    std::string socketPath = UploadDaemon::defaultSocketPath();
+    std::vector<std::string> args{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--verbose") Logger::verboseMode = true;
+        else if (arg == "--bulk") bulk = true;
+        else if (arg == "--stats") showStats = true;
+        else if (arg == "--prewarm") prewarm = true;
+        else if (arg == "--via-daemon") viaDaemon = true;
+        else if (arg == "--connection-cache") connectionCache = true;
+        else if (arg == "--connection-cache-file" && i + 1 < argc) {
+            connectionCache = true;
+            connectionCacheFile = argv[++i];
+        }
+        else if (arg == "--key-validation" && i + 1 < argc) {
+            keyValidation = Config::parseKeyValidation(argv[++i]);
+            if (!keyValidation) {
+                std::cerr << "Unknown key validation mode: " << argv[i] << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--socket" && i + 1 < argc) socketPath = argv[++i];
+        else if (arg == "--api-url" && i + 1 < argc) apiUrl = argv[++i];
+        else if (arg == "--gateway-url" && i + 1 < argc) gatewayUrl = argv[++i];
+        else if (arg == "--metrics-file" && i + 1 < argc) metricsFile = argv[++i];
+        else if (arg == "--metrics-interval" && i + 1 < argc) metricsInterval = std::max(1L, std::atol(argv[++i]));
+        else if (arg == "--direct-io") directIO = true;
+        else if (arg == "--log-overflow" && i + 1 < argc) {
+            auto overflow = Logger::parseOverflow(argv[++i]);
+            if (!overflow) {
+                std::cerr << "Unknown log overflow mode: " << argv[i] << "\n";
+                return 1;
+            }
+            Logger::configure(Logger::DefaultQueueCapacity, *overflow);
+        }
+        else if (arg == "--log-level" && i + 1 < argc) {
+            auto level = Logger::parseLevel(argv[++i]);
+            if (!level) {
+                std::cerr << "Unknown log level: " << argv[i] << "\n";
+                return 1;
+            }
+            Logger::setLevel(*level);
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            auto opened = Trace::open(argv[++i]);
+            if (!opened) {
+                std::cerr << opened.error() << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--record" && i + 1 < argc) {
+            std::vector<std::string_view> endpoints;
+            for (size_t endpoint = 0; endpoint < IPFSClient::EndpointCount; ++endpoint) endpoints.push_back(IPFSClient::endpointName(static_cast<Endpoint>(endpoint)));
+            auto opened = RequestRecorder::open(argv[++i], endpoints);
+            if (!opened) {
+                std::cerr << opened.error() << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--events" && i + 1 < argc) {
+            auto opened = EventLog::open(argv[++i]);
+            if (!opened) {
+                std::cerr << opened.error() << "\n";
+                return 1;
+            }
+        }
+        else args.push_back(arg);
+    }
+    argc = static_cast<int>(args.size());
 
     if (argc < 2) {
         printUsage();
-        curl_global_cleanup();
         return 1;
     }
+    if (viaDaemon && args[1] != "daemon") return forwardToDaemon(args, socketPath);
 
-    bool verbose = false;
-    for (int i = 1; i < argc; ++i) {
-        if (std::string(argv[i]) == "--verbose") {
-            verbose = true;
-            Logger::verboseMode = true;
-        }
+    CURLcode globalInitResult = curl_global_init(CURL_GLOBAL_ALL);
+    if (globalInitResult != CURLE_OK) {
+        std::cerr << "Failed to initialize CURL globally: " << curl_easy_strerror(globalInitResult) << "\n";
+        return 1;
     }
 
     auto configResult = Config::load();
     if (!configResult) {
-        Logger::log(LogLevel::ERROR, "Config load failed: " + std::to_string(static_cast<int>(configResult.error().first)) + " - " + configResult.error().second, true);
+        Logger::error("Config load failed: {} - {}", static_cast<int>(configResult.error().first), configResult.error().second);
         curl_global_cleanup();
         return 1;
     }
+    if (bulk) configResult->uploadSource = UploadSourceMode::Bulk;
+    if (directIO) configResult->bulkDirectIO = true;
+    if (apiUrl) configResult->apiUrl = Config::withTrailingSlash(*apiUrl);
+    if (gatewayUrl) configResult->gatewayUrl = Config::withTrailingSlash(*gatewayUrl);
+    if (keyValidation) configResult->keyValidation = *keyValidation;
+    if (prewarm) configResult->prewarmConnections = true;
+    if (connectionCache) configResult->connectionCache = true;
+    if (!connectionCacheFile.empty()) configResult->connectionCachePath = connectionCacheFile;
+
+    if (args[1] == "daemon") {
+        int status = runDaemon(*configResult, args, socketPath);
+        curl_global_cleanup();
+        return status;
+    }
 
     try {
+        if (args[1] == "bench") {
+            runBench(*configResult, args, showStats);
+            if (auto traced = Trace::close(); !traced) std::cerr << traced.error() << "\n";
+            curl_global_cleanup();
+            return 0;
+        }
+
         IPFSClient client(*configResult);
-        Logger::setProgressCallback([](double percent, double speed, double eta) {
-            int barWidth = 20;
-            int pos = static_cast<int>(percent * barWidth / 100.0);
-            std::cerr << "\r\033[33m[PROGRESS]\033[0m [";
-            for (int i = 0; i < barWidth; ++i) {
-                if (i < pos) std::cerr << "#";
-                else std::cerr << " ";
-            }
-            std::cerr << "] " << std::fixed << std::setprecision(1) << percent << "% | "
-                      << std::setprecision(0) << speed / 1024 << " KB/s | "
-                      << "ETA: " << std::setprecision(1) << eta << "s" << std::flush;
-            if (percent == 100.0) std::cerr << "\n";
-        });
+        std::optional<MetricsExporter> metrics;
+        if (!metricsFile.empty()) metrics.emplace(client, metricsFile, std::chrono::seconds(metricsInterval));
+        if (Logger::verboseMode) Progress::start(renderProgress);
 
-        std::string command = argv[1];
-        if (command == "upload" && argc >= 3) {
-            std::vector<std::string> files{argv[2]};
-            std::optional<Json::Value> metadata;
-            std::optional<std::string> group;
-            for (int i = 3; i < argc - 1; i += 2) {
-                if (std::string(argv[i]) == "--group") group = std::string(argv[i + 1]);
-                else if (std::string(argv[i]) == "--metadata") {
-                    auto json = client.parseJSON(argv[i + 1]);
-                    if (!json) throw std::runtime_error(client.errorToString(json.error()));
-                    metadata = *json;
-                }
-            }
-            if (group) {
-                if (!metadata) metadata = Json::Value(Json::objectValue);
-                (*metadata)["name"] = *group;
-            }
-            auto result = client.upload(files, metadata);
-            if (result) std::cout << "Uploaded: " << (*result)[0] << "\n";
-            else throw std::runtime_error(client.errorToString(result.error()));
-        } else if (command == "batch" && argc >= 3) {
-            std::vector<std::string> files;
-            std::optional<Json::Value> metadata;
-            std::optional<std::string> group;
-            int i = 2;
-            while (i < argc && std::string(argv[i]).substr(0, 2) != "--") {
-                files.push_back(argv[i++]);
-            }
-            for (; i < argc - 1; i += 2) {
-                if (std::string(argv[i]) == "--group") group = std::string(argv[i + 1]);
-                else if (std::string(argv[i]) == "--metadata") {
-                    auto json = client.parseJSON(argv[i + 1]);
-                    if (!json) throw std::runtime_error(client.errorToString(json.error()));
-                    metadata = *json;
-                }
-            }
-            if (group) {
-                if (!metadata) metadata = Json::Value(Json::objectValue);
-                (*metadata)["name"] = *group;
+        std::string command = args[1];
+        if ((command == "upload" || command == "batch") && argc >= 3) {
+            UploadArgs upload = parseUploadArgs(args, command == "batch");
+            if (command == "batch" && (upload.incremental || !upload.journalPath.empty() || !upload.resumePath.empty())) {
+                runBatch(client, std::move(upload));
+            } else {
+                auto result = client.upload(upload.files, upload.metadata);
+                if (!result) throw std::runtime_error(client.errorToString(result.error()));
+                if (command == "upload") std::cout << "Uploaded: " << (*result)[0] << "\n";
+                else for (const auto& hash : *result) std::cout << "Uploaded: " << hash << "\n";
             }
-            auto result = client.upload(files, metadata);
-            if (result) for (const auto& hash : *result) std::cout << "Uploaded: " << hash << "\n";
-            else throw std::runtime_error(client.errorToString(result.error()));
-        } else if (command == "get" && argc >= 3 && std::string(argv[2]).substr(0, 2) != "--") {
-            auto result = client.retrieveContent(argv[2]);
+        } else if (command == "get" && argc >= 3 && args[2].substr(0, 2) != "--") {
+            auto result = client.retrieveContent(args[2]);
             if (result) std::cout << "Content:\n" << *result << "\n";
             else throw std::runtime_error(client.errorToString(result.error()));
         } else if (command == "list") {
             std::optional<std::string> group;
-            if (argc > 3 && std::string(argv[2]) == "--group") group = std::string(argv[3]);
+            if (argc > 3 && args[2] == "--group") group = args[3];
             auto result = client.listPins(group);
             if (result) {
                 Json::StreamWriterBuilder writer;
@@ -117,22 +509,30 @@ int main(int argc, char* argv[]) {
             } else {
                 throw std::runtime_error(client.errorToString(result.error()));
             }
-        } else if (command == "delete" && argc >= 3 && std::string(argv[2]).substr(0, 2) != "--") {
-            auto result = client.deletePin(argv[2]);
-            if (result) std::cout << "Deleted pin: " + std::string(argv[2]) << "\n";
+        } else if (command == "delete" && argc >= 3 && args[2].substr(0, 2) != "--") {
+            auto result = client.deletePin(args[2]);
+            if (result) std::cout << "Deleted pin: " + args[2] << "\n";
             else throw std::runtime_error(client.errorToString(result.error()));
+        } else if (command == "watch" && argc >= 3 && args[2].substr(0, 2) != "--") {
+            runWatch(client, args);
         } else {
+            Progress::stop();
             printUsage();
             curl_global_cleanup();
             return 1;
         }
+        Progress::stop();
+        if (showStats) printLatencyStats(client);
     } catch (const std::exception& e) {
-        Logger::log(LogLevel::ERROR, "Operation failed: " + std::string(e.what()), true);
+        Progress::stop();
+        Logger::error("Operation failed: {}", e.what());
+        Logger::flush();
         std::cerr << "Error: " << e.what() << "\n";
         curl_global_cleanup();
         return 1;
     }
 
+    if (auto traced = Trace::close(); !traced) std::cerr << traced.error() << "\n";
     curl_global_cleanup();
     return 0;
 }
@@ -0,0 +1,98 @@
+#include "event_log.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+std::mutex writerMutex;
+std::FILE* output = nullptr;
+std::string pending;
+std::atomic<uint64_t> requestIds{0};
+
+void writePending() {
+    if (output && !pending.empty()) std::fwrite(pending.data(), 1, pending.size(), output);
+    pending.clear();
+}
+
+}
+
+std::atomic<bool> EventLog::active{false};
+
+void EventLog::appendJsonString(std::string& out, std::string_view value) {
+    out += '"';
+    for (char c : value) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) std::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(c));
+            else out += c;
+        }
+    }
+    out += '"';
+}
+
+EventLog::Event::Event(std::string_view type) {
+    line.reserve(256);
+    auto now = std::chrono::time_point_cast<std::chrono::microseconds>(std::chrono::system_clock::now());
+    std::format_to(std::back_inserter(line), "{{\"ts_us\":{},\"event\":", now.time_since_epoch().count());
+    EventLog::appendJsonString(line, type);
+}
+
+void EventLog::Event::appendKey(std::string_view key) {
+    line += ',';
+    EventLog::appendJsonString(line, key);
+    line += ':';
+}
+
+EventLog::Event& EventLog::Event::field(std::string_view key, std::string_view value) {
+    appendKey(key);
+    EventLog::appendJsonString(line, value);
+    return *this;
+}
+
+std::expected<void, std::string> EventLog::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    std::FILE* file = path == "-" ? stdout : std::fopen(path.c_str(), "a");
+    if (!file) return std::unexpected("Could not open event log " + path + ": " + std::strerror(errno));
+    if (output && output != stdout) std::fclose(output);
+    output = file;
+    pending.reserve(FlushThreshold * 2);
+    if (!active.exchange(true, std::memory_order_acq_rel)) std::atexit(&EventLog::close);
+    return {};
+}
+
+uint64_t EventLog::nextRequestId() {
+    return requestIds.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+void EventLog::emit(Event& event) {
+    event.line += "}\n";
+    std::lock_guard<std::mutex> lock(writerMutex);
+    if (!output) return;
+    pending += event.line;
+    if (pending.size() >= FlushThreshold) writePending();
+}
+
+void EventLog::flush() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    writePending();
+    if (output) std::fflush(output);
+}
+
+void EventLog::close() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    writePending();
+    if (output && output != stdout) std::fclose(output);
+    else if (output) std::fflush(output);
+    output = nullptr;
+    active.store(false, std::memory_order_release);
+}
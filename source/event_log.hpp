@@ -0,0 +1,53 @@
+#ifndef EVENT_LOG_HPP
+#define EVENT_LOG_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+class EventLog {
+public:
+    static constexpr size_t FlushThreshold = 64 * 1024;
+
+    class Event {
+    public:
+        explicit Event(std::string_view type);
+
+        Event& field(std::string_view key, std::string_view value);
+        Event& field(std::string_view key, const char* value) { return field(key, std::string_view(value)); }
+        Event& field(std::string_view key, const std::string& value) { return field(key, std::string_view(value)); }
+        template<typename T>
+            requires std::is_arithmetic_v<T>
+        Event& field(std::string_view key, T value) {
+            appendKey(key);
+            if constexpr (std::is_same_v<T, bool>) line += value ? "true" : "false";
+            else std::format_to(std::back_inserter(line), "{}", value);
+            return *this;
+        }
+
+    private:
+        friend class EventLog;
+        void appendKey(std::string_view key);
+
+        std::string line;
+    };
+
+    static std::expected<void, std::string> open(const std::string& path);
+    static bool enabled() { return active.load(std::memory_order_acquire); }
+    static uint64_t nextRequestId();
+    static void emit(Event& event);
+    static void flush();
+    static void close();
+    static void appendJsonString(std::string& out, std::string_view value);
+
+private:
+    static std::atomic<bool> active;
+};
+
+#endif
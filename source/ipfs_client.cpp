@@ -1,112 +1,518 @@
 #include "ipfs_client.hpp"
+#include "event_log.hpp"
+#include "request_recorder.hpp"
+#include "trace.hpp"
+#include "upload_source.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <chrono>
+#include <limits>
 #include <memory>
+#include <string_view>
 #include <thread>
 
-IPFSClient::IPFSClient(const Config& cfg) : config(cfg), curl(curl_easy_init()) {
-    if (!curl) {
-        Logger::log(LogLevel::ERROR, "Failed to initialize CURL", true);
-        throw std::runtime_error("Failed to initialize CURL");
+std::string_view stripIpfsScheme(std::string_view hash) {
+    if (hash.starts_with("ipfs://")) hash.remove_prefix(7);
+    return hash;
+}
+
+std::string_view IPFSClient::endpointName(Endpoint endpoint) {
+    switch (endpoint) {
+    case Endpoint::PinFileToIPFS: return "pinFileToIPFS";
+    case Endpoint::PinList: return "pinList";
+    case Endpoint::Unpin: return "unpin";
+    case Endpoint::TestAuthentication: return "testAuthentication";
+    case Endpoint::Gateway: return "gateway";
     }
-    Logger::log(LogLevel::INFO, "IPFSClient initialized with PINATA_URL: " + std::string(Config::PINATA_URL), true);
-    validateKeys();
+    return "unknown";
 }
 
-IPFSClient::~IPFSClient() {
-    if (curl) curl_easy_cleanup(curl);
+double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
 }
 
-size_t writeCallback(void* contents, size_t size, size_t nmemb, std::string* data) {
+size_t writeCallback(void* contents, size_t size, size_t nmemb, ResponseSink* sink) {
     size_t totalSize = size * nmemb;
-    data->append(static_cast<char*>(contents), totalSize);
+    sink->pool->append(*sink->buffer, static_cast<char*>(contents), totalSize);
+    return totalSize;
+}
+
+size_t discardCallback(char*, size_t size, size_t nmemb, void*) {
+    return size * nmemb;
+}
+
+std::string_view urlOrigin(std::string_view url) {
+    size_t scheme = url.find("://");
+    size_t path = url.find('/', scheme == std::string_view::npos ? 0 : scheme + 3);
+    return url.substr(0, path);
+}
+
+size_t headerCallback(char* buffer, size_t size, size_t nitems, ResponseSink* sink) {
+    size_t totalSize = size * nitems;
+    constexpr std::string_view name = "content-length:";
+    std::string_view line(buffer, totalSize);
+    if (line.size() > name.size() && std::equal(name.begin(), name.end(), line.begin(), [](char a, char b) {
+            return a == std::tolower(static_cast<unsigned char>(b));
+        })) {
+        std::string_view value = line.substr(name.size());
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+        size_t contentLength = 0;
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), contentLength);
+        if (ec == std::errc() && contentLength > 0) sink->pool->reserve(*sink->buffer, contentLength);
+    }
     return totalSize;
 }
 
-struct ProgressData {
-    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
-};
-
-int progressCallback(void* clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow) {
-    ProgressData* data = static_cast<ProgressData*>(clientp);
-    double percent = (ultotal > 0) ? (static_cast<double>(ulnow) / ultotal) * 100.0 : 0.0;
-    auto now = std::chrono::steady_clock::now();
-    std::chrono::duration<double> elapsed = now - data->startTime;
-    double elapsedSeconds = elapsed.count();
-    double speed = (elapsedSeconds > 0) ? (ulnow / elapsedSeconds) : 0.0;
-    double remainingBytes = ultotal - ulnow;
-    double eta = (speed > 0) ? (remainingBytes / speed) : 0.0;
-    Logger::reportProgress(percent, speed, eta);
+int progressCallback(void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t ulnow) {
+    if (clientp && ulnow > 0) static_cast<Progress::Transfer*>(clientp)->update(static_cast<uint64_t>(ulnow));
     return 0;
 }
 
-Result<std::string> IPFSClient::performCURLRequest(const std::string& url, const std::string& method, curl_mime* mime) {
-    std::lock_guard<std::mutex> lock(curlMutex);
-    std::string response;
-    ProgressData progressData;
+IPFSClient::RequestTiming collectTiming(CURL* curl, Endpoint endpoint, CURLcode result) {
+    IPFSClient::RequestTiming timing;
+    timing.endpoint = endpoint;
+    timing.result = result;
+    curl_off_t value = 0;
+    long connects = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &timing.httpStatus);
+    if (curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &value) == CURLE_OK) timing.nameLookupUs = value;
+    if (curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &value) == CURLE_OK) timing.connectUs = value;
+    if (curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &value) == CURLE_OK) timing.appConnectUs = value;
+    if (curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &value) == CURLE_OK) timing.preTransferUs = value;
+    if (curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &value) == CURLE_OK) timing.startTransferUs = value;
+    if (curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &value) == CURLE_OK) timing.totalUs = value;
+    if (curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &value) == CURLE_OK) timing.bytesUp = value;
+    if (curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &value) == CURLE_OK) timing.bytesDown = value;
+    if (curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects) == CURLE_OK) timing.connectionReused = result == CURLE_OK && connects == 0;
+    return timing;
+}
+
+uint32_t clampUs(int64_t value) {
+    return static_cast<uint32_t>(std::clamp<int64_t>(value, 0, std::numeric_limits<uint32_t>::max()));
+}
+
+void recordTiming(const IPFSClient::RequestTiming& timing, uint64_t startUs) {
+    RecordedRequest request;
+    request.startUs = startUs;
+    request.bytesUp = static_cast<uint64_t>(std::max<int64_t>(timing.bytesUp, 0));
+    request.bytesDown = static_cast<uint64_t>(std::max<int64_t>(timing.bytesDown, 0));
+    request.nameLookupUs = clampUs(timing.nameLookupUs);
+    request.connectUs = clampUs(timing.connectUs);
+    request.appConnectUs = clampUs(timing.appConnectUs);
+    request.preTransferUs = clampUs(timing.preTransferUs);
+    request.startTransferUs = clampUs(timing.startTransferUs);
+    request.totalUs = clampUs(timing.totalUs);
+    request.httpStatus = static_cast<uint16_t>(std::clamp<long>(timing.httpStatus, 0, 999));
+    request.curlResult = static_cast<uint16_t>(timing.result);
+    request.endpoint = static_cast<uint8_t>(timing.endpoint);
+    request.connectionReused = timing.connectionReused;
+    RequestRecorder::record(request);
+}
+
+void traceTiming(const IPFSClient::RequestTiming& timing, int64_t startUs) {
+    auto phase = [startUs](const char* name, int64_t from, int64_t to) {
+        if (to > from) Trace::complete(name, "curl", startUs + from, to - from);
+    };
+    phase("dns", 0, timing.nameLookupUs);
+    phase("connect", timing.nameLookupUs, timing.connectUs);
+    phase("tls", timing.connectUs, timing.appConnectUs);
+    phase("send + server", timing.preTransferUs, timing.startTransferUs);
+    phase("receive", timing.startTransferUs, timing.totalUs);
+}
+
+void lockShare(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+    (*static_cast<std::array<std::mutex, CURL_LOCK_DATA_LAST>*>(userptr))[data].lock();
+}
 
-    Logger::log(LogLevel::INFO, "Preparing " + method + " request to: " + url, true);
+void unlockShare(CURL*, curl_lock_data data, void* userptr) {
+    (*static_cast<std::array<std::mutex, CURL_LOCK_DATA_LAST>*>(userptr))[data].unlock();
+}
 
-    curl_easy_reset(curl);
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+IPFSClient::IPFSClient(const Config& cfg) : config(cfg), templateHandle(curl_easy_init()) {
+    if (!templateHandle) {
+        Logger::error("Failed to initialize CURL");
+        throw std::runtime_error("Failed to initialize CURL");
+    }
 
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, ("pinata_api_key: " + config.pinataApiKey).c_str());
+    try {
+        share = curl_share_init();
+        if (share) {
+            curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lockShare);
+            curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+            curl_share_setopt(share, CURLSHOPT_USERDATA, &shareLocks);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+        }
+
+        authHeaders = authHeaderList(config);
+        uploadHeaders = authHeaderList(config, true);
+
+        curl_easy_setopt(templateHandle, CURLOPT_HTTPHEADER, authHeaders);
+        curl_easy_setopt(templateHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        curl_easy_setopt(templateHandle, CURLOPT_CONNECTTIMEOUT, 30L);
+        curl_easy_setopt(templateHandle, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(templateHandle, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(templateHandle, CURLOPT_NOPROGRESS, 1L);
+        curl_easy_setopt(templateHandle, CURLOPT_WRITEFUNCTION, writeCallback);
+        curl_easy_setopt(templateHandle, CURLOPT_HEADERFUNCTION, headerCallback);
+        if (config.connectionCache) {
+            connectionCache = std::make_unique<ConnectionCache>(config.connectionCachePath.empty() ? ConnectionCache::defaultPath() : std::filesystem::path(config.connectionCachePath),
+                                                                std::chrono::seconds(config.dnsCacheTtl));
+            resolveOverrides = connectionCache->resolveOverrides();
+            if (resolveOverrides) curl_easy_setopt(templateHandle, CURLOPT_RESOLVE, resolveOverrides);
+        }
+
+        std::string apiUrl = Config::withTrailingSlash(config.apiUrl);
+        setupEndpoint(Endpoint::PinFileToIPFS, apiUrl + "pinning/pinFileToIPFS");
+        setupEndpoint(Endpoint::PinList, apiUrl + "data/pinList");
+        setupEndpoint(Endpoint::Unpin, apiUrl + "pinning/unpin/");
+        setupEndpoint(Endpoint::TestAuthentication, apiUrl + "data/testAuthentication");
+        setupEndpoint(Endpoint::Gateway, Config::withTrailingSlash(config.gatewayUrl));
+        if (connectionCache) connectionCache->importSessions(handle(Endpoint::TestAuthentication).curl);
+
+        Logger::info("IPFSClient initialized with API URL: {}", apiUrl);
+        if (config.prewarmConnections) {
+            std::vector<std::string> origins;
+            bool validating = config.keyValidation == KeyValidation::Eager || config.keyValidation == KeyValidation::Async;
+            if (!validating) origins.emplace_back(urlOrigin(apiUrl));
+            if (urlOrigin(config.gatewayUrl) != urlOrigin(apiUrl)) origins.emplace_back(urlOrigin(config.gatewayUrl));
+            if (!origins.empty()) prewarmer = std::thread(&IPFSClient::prewarm, this, std::move(origins));
+        }
+        switch (config.keyValidation) {
+        case KeyValidation::Eager:
+            validateKeys();
+            break;
+        case KeyValidation::Cached: {
+            KeyCache cache = keyCache();
+            std::string digest = KeyCache::digest(config);
+            if (cache.contains(digest)) {
+                keyState = KeyState::Valid;
+                Logger::info("Pinata API keys validated from cache");
+            } else {
+                validateKeys();
+                cache.store(digest);
+            }
+            break;
+        }
+        case KeyValidation::Async:
+            asyncValidation = std::async(std::launch::async, [this] { return checkKeys(); }).share();
+            break;
+        case KeyValidation::Lazy:
+            break;
+        }
+    } catch (...) {
+        prewarmStopping = true;
+        if (prewarmer.joinable()) prewarmer.join();
+        saveConnectionCache();
+        releaseHandles();
+        throw;
+    }
+}
+
+curl_slist* IPFSClient::authHeaderList(const Config& config, bool multipart) {
+    curl_slist* headers = curl_slist_append(nullptr, ("pinata_api_key: " + config.pinataApiKey).c_str());
     headers = curl_slist_append(headers, ("pinata_secret_api_key: " + config.pinataSecret).c_str());
-    if (mime) {
-        headers = curl_slist_append(headers, "Content-Type: multipart/form-data");
+    if (multipart) headers = curl_slist_append(headers, "Content-Type: multipart/form-data");
+    return headers;
+}
+
+std::string IPFSClient::requestUrl(std::string_view baseUrl, std::initializer_list<std::string_view> urlSuffix) {
+    size_t length = baseUrl.size();
+    for (std::string_view part : urlSuffix) length += part.size();
+    std::string url;
+    url.reserve(length);
+    url += baseUrl;
+    for (std::string_view part : urlSuffix) url += part;
+    return url;
+}
+
+void IPFSClient::setupEndpoint(Endpoint endpoint, std::string baseUrl) {
+    EndpointHandle& target = handle(endpoint);
+    target.curl = curl_easy_duphandle(templateHandle);
+    if (!target.curl) {
+        Logger::error("Failed to duplicate CURL template handle");
+        throw std::runtime_error("Failed to duplicate CURL template handle");
     }
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    target.baseUrl = std::move(baseUrl);
+    target.lastTiming.endpoint = endpoint;
+    curl_easy_setopt(target.curl, CURLOPT_URL, target.baseUrl.c_str());
+    if (share) curl_easy_setopt(target.curl, CURLOPT_SHARE, share);
 
-    if (method == "POST" && mime) {
-        curl_easy_setopt(curl, CURLOPT_MIMEPOST, mime);
-        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progressCallback);
-        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &progressData);
-        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
-    } else {
-        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, nullptr);
-        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, nullptr);
-        if (method == "DELETE") {
-            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-        } else {
-            curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    switch (endpoint) {
+    case Endpoint::PinFileToIPFS:
+        curl_easy_setopt(target.curl, CURLOPT_HTTPHEADER, uploadHeaders);
+        curl_easy_setopt(target.curl, CURLOPT_UPLOAD_BUFFERSIZE, config.uploadBufferSize);
+        curl_easy_setopt(target.curl, CURLOPT_XFERINFOFUNCTION, progressCallback);
+        curl_easy_setopt(target.curl, CURLOPT_NOPROGRESS, 0L);
+        break;
+    case Endpoint::Unpin:
+        curl_easy_setopt(target.curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+        break;
+    case Endpoint::PinList:
+    case Endpoint::TestAuthentication:
+    case Endpoint::Gateway:
+        curl_easy_setopt(target.curl, CURLOPT_HTTPGET, 1L);
+        break;
+    }
+}
+
+IPFSClient::~IPFSClient() {
+    prewarmStopping = true;
+    if (prewarmer.joinable()) prewarmer.join();
+    if (asyncValidation.valid()) asyncValidation.wait();
+    saveConnectionCache();
+    if (config.uploadSource == UploadSourceMode::Bulk) Logger::info("Bulk mode bypassed {} bytes of page cache", cacheBypassedBytes.load(std::memory_order_relaxed));
+    if (Logger::enabled(LogLevel::DEBUG)) {
+        ClientStats clientStats = stats();
+        Logger::debug("Response buffers: {} requests, {} reused, {} heap allocations", clientStats.responseBuffers.acquired, clientStats.responseBuffers.reused, clientStats.responseBuffers.heapAllocations);
+    }
+    releaseHandles();
+}
+
+void IPFSClient::releaseHandles() {
+    for (auto& endpoint : handles) {
+        if (endpoint.curl) curl_easy_cleanup(endpoint.curl);
+    }
+    if (share) curl_share_cleanup(share);
+    if (templateHandle) curl_easy_cleanup(templateHandle);
+    curl_slist_free_all(authHeaders);
+    curl_slist_free_all(uploadHeaders);
+    curl_slist_free_all(resolveOverrides);
+}
+
+void IPFSClient::saveConnectionCache() {
+    if (!connectionCache) return;
+    for (auto& endpoint : handles) {
+        if (!endpoint.curl) continue;
+        std::lock_guard<std::mutex> lock(endpoint.mutex);
+        switch (endpoint.lastTiming.result) {
+        case CURLE_OK:
+            if (endpoint.lastTiming.httpStatus != 0) connectionCache->rememberAddress(endpoint.baseUrl, endpoint.curl);
+            break;
+        case CURLE_COULDNT_RESOLVE_HOST:
+        case CURLE_COULDNT_CONNECT:
+        case CURLE_OPERATION_TIMEDOUT:
+        case CURLE_SSL_CONNECT_ERROR:
+            connectionCache->forgetAddress(endpoint.baseUrl);
+            break;
+        default:
+            break;
         }
-        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L);
+    }
+    if (CURL* curl = handle(Endpoint::TestAuthentication).curl) connectionCache->exportSessions(curl);
+    connectionCache->save();
+}
+
+Result<BufferPool::Lease> IPFSClient::performCURLRequest(Endpoint endpoint, std::initializer_list<std::string_view> urlSuffix, curl_mime* mime, RequestTiming* timing, Progress::Transfer* transfer) {
+    EndpointHandle& target = handle(endpoint);
+    std::string url = requestUrl(target.baseUrl, urlSuffix);
+
+    bool authenticated = endpoint != Endpoint::Gateway && endpoint != Endpoint::TestAuthentication;
+    if (authenticated && keyState.load(std::memory_order_acquire) == KeyState::Invalid) {
+        std::lock_guard<std::mutex> lock(keyMutex);
+        return std::unexpected(std::make_pair(IPFSError::PinataError, keyError));
     }
 
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    std::lock_guard<std::mutex> lock(target.mutex);
+    BufferPool::Lease response = target.responsePool.acquire();
+    ResponseSink sink{&target.responsePool, &response.buffer()};
+
+    Logger::debug("Preparing request to: {}", url);
+    Trace::Span span("performCURLRequest", "http", endpointName(endpoint));
+    uint64_t requestId = 0;
+    if (EventLog::enabled()) {
+        requestId = EventLog::nextRequestId();
+        EventLog::Event event("request_start");
+        event.field("id", requestId).field("endpoint", endpointName(endpoint)).field("url", std::string_view(url));
+        EventLog::emit(event);
+    }
+
+    curl_easy_setopt(target.curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(target.curl, CURLOPT_WRITEDATA, &sink);
+    curl_easy_setopt(target.curl, CURLOPT_HEADERDATA, &sink);
+    if (mime) {
+        curl_easy_setopt(target.curl, CURLOPT_MIMEPOST, mime);
+        curl_easy_setopt(target.curl, CURLOPT_XFERINFODATA, transfer);
+    }
 
-    CURLcode res = curl_easy_perform(curl);
+    inFlightRequests.fetch_add(1, std::memory_order_relaxed);
+    int64_t performStartUs = Trace::enabled() ? Trace::nowUs() : 0;
+    uint64_t recordStartUs = RequestRecorder::enabled() ? RequestRecorder::nowUs() : 0;
+    CURLcode res = curl_easy_perform(target.curl);
+    if (mime) {
+        curl_easy_setopt(target.curl, CURLOPT_MIMEPOST, nullptr);
+        curl_easy_setopt(target.curl, CURLOPT_XFERINFODATA, nullptr);
+    }
+    RequestTiming measured = collectTiming(target.curl, endpoint, res);
+    target.lastTiming = measured;
+    inFlightRequests.fetch_sub(1, std::memory_order_relaxed);
+    size_t statusSlot = res == CURLE_OK && measured.httpStatus >= 100 && measured.httpStatus < static_cast<long>(StatusSlots) ? static_cast<size_t>(measured.httpStatus) : 0;
+    statusCounts[static_cast<size_t>(endpoint)][statusSlot].fetch_add(1, std::memory_order_relaxed);
+    bytesUploaded.fetch_add(static_cast<uint64_t>(measured.bytesUp), std::memory_order_relaxed);
+    bytesDownloaded.fetch_add(static_cast<uint64_t>(measured.bytesDown), std::memory_order_relaxed);
+    if (timing) *timing = measured;
+    if (Trace::enabled()) traceTiming(measured, performStartUs);
+    if (RequestRecorder::enabled()) recordTiming(measured, recordStartUs);
+    if (timingCallback) timingCallback(measured);
+    if (res == CURLE_OK) {
+        auto& histograms = latencyHistograms[static_cast<size_t>(endpoint)];
+        histograms[static_cast<size_t>(LatencyPhase::TimeToFirstByte)].record(static_cast<uint64_t>(measured.startTransferUs));
+        histograms[static_cast<size_t>(LatencyPhase::Total)].record(static_cast<uint64_t>(measured.totalUs));
+    }
+    Logger::debug("{} HTTP {} in {:.1f} ms (dns {:.1f}, connect {:.1f}, tls {:.1f}, ttfb {:.1f}), {} B up, {} B down{}", endpointName(endpoint),
+                  measured.httpStatus, measured.totalUs / 1000.0, measured.nameLookupUs / 1000.0, measured.connectUs / 1000.0, measured.appConnectUs / 1000.0,
+                  measured.startTransferUs / 1000.0, measured.bytesUp, measured.bytesDown, measured.connectionReused ? ", reused connection" : "");
+    if (EventLog::enabled()) {
+        EventLog::Event event("request_end");
+        event.field("id", requestId).field("endpoint", endpointName(endpoint)).field("http_status", measured.httpStatus);
+        event.field("bytes_up", measured.bytesUp).field("bytes_down", measured.bytesDown).field("reused", measured.connectionReused);
+        event.field("dns_ms", measured.nameLookupUs / 1000.0).field("connect_ms", measured.connectUs / 1000.0).field("tls_ms", measured.appConnectUs / 1000.0);
+        event.field("pretransfer_ms", measured.preTransferUs / 1000.0).field("ttfb_ms", measured.startTransferUs / 1000.0).field("total_ms", measured.totalUs / 1000.0);
+        if (res != CURLE_OK) event.field("error", curl_easy_strerror(res));
+        EventLog::emit(event);
+    }
+    if (authenticated && res == CURLE_OK && measured.httpStatus == 401) {
+        if (auto keys = recheckKeys(); !keys) return std::unexpected(keys.error());
+    }
     if (res != CURLE_OK) {
         std::string error = curl_easy_strerror(res);
-        Logger::log(LogLevel::ERROR, "CURL failed: " + error, true);
-        curl_slist_free_all(headers);
+        Logger::error("CURL failed: {}", error);
         return std::unexpected(std::make_pair(IPFSError::CURLFailure, error));
     }
 
-    Logger::log(LogLevel::INFO, "Response: " + response, true);
-    curl_slist_free_all(headers);
+    Logger::debug("Response: {}", response.str());
     return response;
 }
 
+IPFSClient::RequestTiming IPFSClient::lastTiming(Endpoint endpoint) {
+    EndpointHandle& target = handle(endpoint);
+    std::lock_guard<std::mutex> lock(target.mutex);
+    return target.lastTiming;
+}
+
+void IPFSClient::setTimingCallback(std::function<void(const RequestTiming&)> callback) {
+    timingCallback = std::move(callback);
+}
+
+LatencySnapshot IPFSClient::latency(Endpoint endpoint, LatencyPhase phase) const {
+    return latencyHistograms[static_cast<size_t>(endpoint)][static_cast<size_t>(phase)].snapshot();
+}
+
+void IPFSClient::waitBeforeRetry(const RequestTiming& timing, std::chrono::seconds delay) {
+    Trace::Span span("retry backoff", "retry");
+    uploadRetries.fetch_add(1, std::memory_order_relaxed);
+    if (timing.httpStatus == 429) {
+        rateLimitWaits.fetch_add(1, std::memory_order_relaxed);
+        rateLimitWaitMicros.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(delay).count()), std::memory_order_relaxed);
+    }
+    std::this_thread::sleep_for(delay);
+}
+
+void IPFSClient::prewarm(std::vector<std::string> origins) {
+    Trace::Span span("prewarm", "http");
+    CURLM* multi = curl_multi_init();
+    if (!multi) return;
+    std::vector<CURL*> handles;
+    for (const auto& origin : origins) {
+        CURL* curl = curl_easy_duphandle(templateHandle);
+        if (!curl) continue;
+        std::string url = origin + "/";
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discardCallback);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, discardCallback);
+        curl_easy_setopt(curl, CURLOPT_PRIVATE, origin.c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, nullptr);
+        if (share) curl_easy_setopt(curl, CURLOPT_SHARE, share);
+        curl_multi_add_handle(multi, curl);
+        handles.push_back(curl);
+    }
+
+    int running = 0;
+    do {
+        curl_multi_perform(multi, &running);
+        if (running) curl_multi_poll(multi, nullptr, 0, 100, nullptr);
+    } while (running && !prewarmStopping);
+
+    int queued = 0;
+    while (CURLMsg* message = curl_multi_info_read(multi, &queued)) {
+        if (message->msg != CURLMSG_DONE) continue;
+        char* origin = nullptr;
+        curl_off_t connectUs = 0;
+        curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &origin);
+        curl_easy_getinfo(message->easy_handle, CURLINFO_APPCONNECT_TIME_T, &connectUs);
+        if (connectUs == 0) curl_easy_getinfo(message->easy_handle, CURLINFO_CONNECT_TIME_T, &connectUs);
+        if (message->data.result == CURLE_OK) Logger::debug("Pre-warmed connection to {} in {:.1f} ms", origin, connectUs / 1000.0);
+        else Logger::debug("Pre-warming {} failed: {}", origin, curl_easy_strerror(message->data.result));
+    }
+    for (CURL* curl : handles) {
+        curl_multi_remove_handle(multi, curl);
+        curl_easy_cleanup(curl);
+    }
+    curl_multi_cleanup(multi);
+}
+
 void IPFSClient::validateKeys() {
-    std::string url = std::string(Config::PINATA_URL) + "data/testAuthentication";
-    Logger::log(LogLevel::INFO, "Validating keys with URL: " + url, true);
-    auto response = performCURLRequest(url, "GET");
+    auto keys = checkKeys();
+    if (!keys) throw std::runtime_error(keys.error().second);
+}
+
+Result<void> IPFSClient::checkKeys() {
+    Logger::info("Validating keys with URL: {}", handle(Endpoint::TestAuthentication).baseUrl);
+    auto response = performCURLRequest(Endpoint::TestAuthentication);
+    std::string error;
     if (!response) {
-        Logger::log(LogLevel::ERROR, "Validation CURL failed: " + response.error().second, true);
-        throw std::runtime_error("CURL failed in validation: " + response.error().second);
+        Logger::error("Validation CURL failed: {}", response.error().second);
+        error = "CURL failed in validation: " + response.error().second;
+    } else {
+        auto json = parseJSON(response->str());
+        if (!json || json->isMember("error")) {
+            std::string errorMsg = response->str().empty() ? "No response" : response->str();
+            Logger::error("Key validation failed with response: {}", errorMsg);
+            error = "Invalid Pinata API keys: " + errorMsg;
+        }
     }
-    auto json = parseJSON(*response);
-    if (!json || json->isMember("error")) {
-        std::string errorMsg = response ? *response : "No response";
-        Logger::log(LogLevel::ERROR, "Key validation failed with response: " + errorMsg, true);
-        throw std::runtime_error("Invalid Pinata API keys: " + errorMsg);
+    if (!error.empty()) {
+        if (response) {
+            std::lock_guard<std::mutex> lock(keyMutex);
+            keyError = error;
+            keyState.store(KeyState::Invalid, std::memory_order_release);
+        }
+        return std::unexpected(std::make_pair(response ? IPFSError::PinataError : IPFSError::CURLFailure, error));
     }
-    Logger::log(LogLevel::INFO, "Pinata API keys validated successfully", true);
+    keyState.store(KeyState::Valid, std::memory_order_release);
+    Logger::info("Pinata API keys validated successfully");
+    return {};
+}
+
+Result<void> IPFSClient::recheckKeys() {
+    if (asyncValidation.valid()) return asyncValidation.get();
+    if (config.keyValidation == KeyValidation::Eager) return {};
+    KeyCache cache = keyCache();
+    std::string digest = KeyCache::digest(config);
+    if (config.keyValidation == KeyValidation::Cached) cache.forget(digest);
+    auto keys = checkKeys();
+    if (keys && config.keyValidation == KeyValidation::Cached) cache.store(digest);
+    return keys;
+}
+
+KeyCache IPFSClient::keyCache() const {
+    return KeyCache(config.keyCachePath.empty() ? KeyCache::defaultPath() : fs::path(config.keyCachePath), std::chrono::seconds(config.keyValidationTtl));
+}
+
+std::string IPFSClient::serializeMetadata(const Json::Value& metadata) {
+    static const Json::StreamWriterBuilder writer = [] {
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        return builder;
+    }();
+    return Json::writeString(writer, metadata);
 }
 
 Result<Json::Value> IPFSClient::parseJSON(const std::string& data) {
+    Trace::Span span("parseJSON", "json");
     Json::Value result;
     Json::CharReaderBuilder builder;
     std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
@@ -119,53 +525,105 @@ Result<Json::Value> IPFSClient::parseJSON(const std::string& data) {
 
 Result<std::string> IPFSClient::performUpload(const std::string& filePath, const std::optional<Json::Value>& metadata, int retries, std::chrono::seconds retryDelay) {
     if (!fs::exists(filePath)) {
-        Logger::log(LogLevel::ERROR, "File not found: " + filePath, true);
+        Logger::error("File not found: {}", filePath);
+        if (EventLog::enabled()) {
+            EventLog::Event event("upload_end");
+            event.field("file", filePath).field("attempt", 0).field("error", "File not found");
+            EventLog::emit(event);
+        }
+        Progress::fileFailed();
         return std::unexpected(std::make_pair(IPFSError::FileNotFound, "File not found: " + filePath));
     }
 
+    std::string metadataStr = metadata ? serializeMetadata(*metadata) : std::string();
     for (int attempt = 0; attempt <= retries; ++attempt) {
-        Logger::resetProgress();
-        curl_mime* mime = curl_mime_init(curl);
+        Trace::Span attemptSpan("upload attempt", "upload", filePath);
+        std::optional<MappedUploadSource> mapped;
+        std::optional<BulkUploadSource> bulk;
+        if (config.uploadSource == UploadSourceMode::Mapped) {
+            auto source = MappedUploadSource::open(filePath);
+            if (source) mapped = std::move(*source);
+            else Logger::warn("Falling back to buffered upload: {}", source.error());
+        } else if (config.uploadSource == UploadSourceMode::Bulk) {
+            auto source = BulkUploadSource::open(filePath, config.bulkDirectIO);
+            if (source) bulk = std::move(*source);
+            else Logger::warn("Falling back to buffered upload: {}", source.error());
+        }
+
+        std::error_code sizeError;
+        uint64_t fileBytes = fs::file_size(filePath, sizeError);
+        auto started = std::chrono::steady_clock::now();
+        if (EventLog::enabled()) {
+            EventLog::Event event("upload_start");
+            event.field("file", filePath).field("bytes", fileBytes).field("attempt", attempt + 1).field("source", mapped ? "mapped" : bulk ? "bulk" : "stdio");
+            EventLog::emit(event);
+        }
+        auto emitUploadEnd = [&](long status, std::string_view key, std::string_view value) {
+            if (!EventLog::enabled()) return;
+            EventLog::Event event("upload_end");
+            event.field("file", filePath).field("bytes", fileBytes).field("attempt", attempt + 1).field("http_status", status);
+            event.field("total_ms", elapsedMs(started)).field(key, value);
+            EventLog::emit(event);
+        };
+
+        curl_mime* mime = curl_mime_init(handle(Endpoint::PinFileToIPFS).curl);
         curl_mimepart* part = curl_mime_addpart(mime);
         curl_mime_name(part, "file");
-        curl_mime_filedata(part, filePath.c_str());
+        if (mapped) mapped->attach(part);
+        else if (bulk) bulk->attach(part);
+        else curl_mime_filedata(part, filePath.c_str());
         curl_mime_filename(part, fs::path(filePath).filename().string().c_str());
 
         if (metadata) {
-            Json::StreamWriterBuilder writer;
-            std::string metadataStr = Json::writeString(writer, *metadata);
             part = curl_mime_addpart(mime);
             curl_mime_name(part, "pinataMetadata");
             curl_mime_data(part, metadataStr.c_str(), CURL_ZERO_TERMINATED);
         }
 
-        std::string url = std::string(Config::PINATA_URL) + "pinning/pinFileToIPFS";
-        auto response = performCURLRequest(url, "POST", mime);
+        RequestTiming timing;
+        Progress::Transfer transfer(fileBytes);
+        auto response = performCURLRequest(Endpoint::PinFileToIPFS, {}, mime, &timing, &transfer);
         curl_mime_free(mime);
+        if (bulk) {
+            bulk->releaseCache();
+            cacheBypassedBytes.fetch_add(bulk->bytesBypassed(), std::memory_order_relaxed);
+        }
 
         if (!response) {
-            Logger::log(LogLevel::ERROR, "Upload attempt " + std::to_string(attempt + 1) + " failed: " + response.error().second, true);
-            if (attempt == retries) return std::unexpected(response.error());
-            std::this_thread::sleep_for(retryDelay);
+            Logger::error("Upload attempt {} failed: {}", attempt + 1, response.error().second);
+            emitUploadEnd(timing.httpStatus, "error", response.error().second);
+            if (attempt == retries || keyState.load(std::memory_order_acquire) == KeyState::Invalid) {
+                Progress::fileFailed();
+                return std::unexpected(response.error());
+            }
+            waitBeforeRetry(timing, retryDelay);
             continue;
         }
 
-        auto json = parseJSON(*response);
+        auto json = parseJSON(response->str());
         if (!json || !json->isMember("IpfsHash")) {
             Json::StreamWriterBuilder writer;
             std::string errorDetail = json ? Json::writeString(writer, *json) : "No JSON response";
-            Logger::log(LogLevel::ERROR, "Pinata error on attempt " + std::to_string(attempt + 1) + ": " + errorDetail, true);
-            if (attempt == retries) return std::unexpected(std::make_pair(IPFSError::PinataError, "Pinata response missing IpfsHash: " + errorDetail));
-            std::this_thread::sleep_for(retryDelay);
+            Logger::error("Pinata error on attempt {}: {}", attempt + 1, errorDetail);
+            emitUploadEnd(timing.httpStatus, "error", errorDetail);
+            if (attempt == retries) {
+                Progress::fileFailed();
+                return std::unexpected(std::make_pair(IPFSError::PinataError, "Pinata response missing IpfsHash: " + errorDetail));
+            }
+            waitBeforeRetry(timing, retryDelay);
             continue;
         }
 
-        return "ipfs://" + json->get("IpfsHash", "").asString();
+        std::string cid = json->get("IpfsHash", "").asString();
+        transfer.complete();
+        emitUploadEnd(timing.httpStatus, "cid", cid);
+        return "ipfs://" + cid;
     }
     return std::unexpected(std::make_pair(IPFSError::PinataError, "All upload attempts failed"));
 }
 
 Result<std::vector<std::string>> IPFSClient::upload(const std::vector<std::string>& files, const std::optional<Json::Value>& metadata, std::unique_ptr<UploadStrategy> strategy) {
+    Progress::expectFiles(files.size());
     if (!strategy) {
         if (files.size() == 1) {
             strategy = std::make_unique<SingleFileStrategy>();
@@ -177,53 +635,72 @@ Result<std::vector<std::string>> IPFSClient::upload(const std::vector<std::strin
 }
 
 Result<std::string> IPFSClient::retrieveContent(const std::string& ipfsHash) {
-    std::string hashStr = ipfsHash;
-    if (hashStr.substr(0, 7) == "ipfs://") hashStr = hashStr.substr(7);
-    return performCURLRequest(std::string(Config::IPFS_GATEWAY) + hashStr, "GET");
+    auto response = performCURLRequest(Endpoint::Gateway, {stripIpfsScheme(ipfsHash)});
+    if (!response) return std::unexpected(response.error());
+    return response->take();
 }
 
 Result<Json::Value> IPFSClient::listPins(const std::optional<std::string>& group) {
-    std::string url = std::string(Config::PINATA_URL) + "data/pinList";
-    if (group) url += "?metadata[name]=" + *group;
-    return parseJSON(*performCURLRequest(url, "GET"));
+    auto response = group ? performCURLRequest(Endpoint::PinList, {"?metadata[name]=", *group})
+                          : performCURLRequest(Endpoint::PinList);
+    if (!response) return std::unexpected(response.error());
+    return parseJSON(response->str());
 }
 
 Result<void> IPFSClient::deletePin(const std::string& ipfsHash) {
-    std::string hashStr = ipfsHash;
-    if (hashStr.substr(0, 7) == "ipfs://") hashStr = hashStr.substr(7);
-    auto response = performCURLRequest(std::string(Config::PINATA_URL) + "pinning/unpin/" + hashStr, "DELETE");
+    auto response = performCURLRequest(Endpoint::Unpin, {stripIpfsScheme(ipfsHash)});
     if (!response) return std::unexpected(response.error());
 
-    auto json = parseJSON(*response);
+    const std::string& body = response->str();
+    auto json = parseJSON(body);
     if (!json) {
-        if (response->find("error") == std::string::npos) {
-            Logger::log(LogLevel::INFO, "Warning: Unexpected non-JSON response: " + *response + ", assuming success", true);
-            Logger::log(LogLevel::INFO, "Successfully deleted " + ipfsHash, true);
+        if (body.find("error") == std::string::npos) {
+            Logger::warn("Unexpected non-JSON response: {}, assuming success", body);
+            Logger::info("Successfully deleted {}", ipfsHash);
             return {};
         }
-        Logger::log(LogLevel::ERROR, "Delete failed with unparseable response: " + *response, true);
-        return std::unexpected(std::make_pair(IPFSError::PinataError, "Failed to delete pin: unparseable response - " + *response));
+        Logger::error("Delete failed with unparseable response: {}", body);
+        return std::unexpected(std::make_pair(IPFSError::PinataError, "Failed to delete pin: unparseable response - " + body));
     }
 
     if (json->isMember("error")) {
         Json::StreamWriterBuilder writer;
         std::string errorDetail = Json::writeString(writer, *json);
-        Logger::log(LogLevel::ERROR, "Delete failed: " + errorDetail, true);
+        Logger::error("Delete failed: {}", errorDetail);
         return std::unexpected(std::make_pair(IPFSError::PinataError, "Failed to delete pin: " + errorDetail));
     }
 
-    Logger::log(LogLevel::INFO, "Successfully deleted " + ipfsHash, true);
+    Logger::info("Successfully deleted {}", ipfsHash);
     return {};
 }
 
 std::string IPFSClient::errorToString(const std::pair<IPFSError, std::string>& error) {
-    std::string base;
-    switch (error.first) {
-    case IPFSError::FileNotFound: base = "File not found"; break;
-    case IPFSError::CURLFailure: base = "CURL request failed"; break;
-    case IPFSError::JSONParseError: base = "JSON parsing error"; break;
-    case IPFSError::PinataError: base = "Pinata service error"; break;
-    case IPFSError::InvalidInput: base = "Invalid input"; break;
-    }
-    return base + " - Details: " + error.second;
+    return std::format("{} - Details: {}", error.first, error.second);
+}
+
+IPFSClient::ClientStats IPFSClient::stats() const {
+    ClientStats result;
+    for (const auto& endpoint : handles) {
+        BufferPoolStats poolStats = endpoint.responsePool.stats();
+        result.responseBuffers.acquired += poolStats.acquired;
+        result.responseBuffers.reused += poolStats.reused;
+        result.responseBuffers.heapAllocations += poolStats.heapAllocations;
+        result.responseBuffers.reservations += poolStats.reservations;
+        result.responseBuffers.bytesReceived += poolStats.bytesReceived;
+        result.responseBuffers.retainedCapacity += poolStats.retainedCapacity;
+    }
+    result.cacheBypassedBytes = cacheBypassedBytes.load(std::memory_order_relaxed);
+    result.bytesUploaded = bytesUploaded.load(std::memory_order_relaxed);
+    result.bytesDownloaded = bytesDownloaded.load(std::memory_order_relaxed);
+    result.uploadRetries = uploadRetries.load(std::memory_order_relaxed);
+    result.rateLimitWaits = rateLimitWaits.load(std::memory_order_relaxed);
+    result.rateLimitWaitSeconds = static_cast<double>(rateLimitWaitMicros.load(std::memory_order_relaxed)) / 1e6;
+    result.inFlightRequests = inFlightRequests.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < EndpointCount; ++i) {
+        for (size_t slot = 0; slot < StatusSlots; ++slot) {
+            uint64_t count = statusCounts[i][slot].load(std::memory_order_relaxed);
+            if (count > 0) result.requests.push_back({static_cast<Endpoint>(i), static_cast<long>(slot), count});
+        }
+    }
+    return result;
 }
@@ -1,30 +1,108 @@
 #ifndef IPFS_CLIENT_HPP
 #define IPFS_CLIENT_HPP
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <initializer_list>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <expected>
 #include <curl/curl.h>
 #include <json/json.h>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include "buffer_pool.hpp"
 #include "config.hpp"
+#include "connection_cache.hpp"
+#include "key_cache.hpp"
+#include "latency_histogram.hpp"
 #include "logger.hpp"
+#include "prefetcher.hpp"
+#include "progress.hpp"
 
 namespace fs = std::filesystem;
 
 enum class IPFSError { FileNotFound, CURLFailure, JSONParseError, PinataError, InvalidInput };
 
+template<>
+struct std::formatter<IPFSError> : std::formatter<std::string_view> {
+    auto format(IPFSError error, std::format_context& ctx) const {
+        std::string_view name;
+        switch (error) {
+        case IPFSError::FileNotFound: name = "File not found"; break;
+        case IPFSError::CURLFailure: name = "CURL request failed"; break;
+        case IPFSError::JSONParseError: name = "JSON parsing error"; break;
+        case IPFSError::PinataError: name = "Pinata service error"; break;
+        case IPFSError::InvalidInput: name = "Invalid input"; break;
+        }
+        return std::formatter<std::string_view>::format(name, ctx);
+    }
+};
+
+enum class Endpoint { PinFileToIPFS, PinList, Unpin, TestAuthentication, Gateway };
+enum class LatencyPhase { TimeToFirstByte, Total };
+
 template<typename T>
 using Result = std::expected<T, std::pair<IPFSError, std::string>>;
 
+struct ResponseSink {
+    BufferPool* pool;
+    std::string* buffer;
+};
+
+size_t writeCallback(void* contents, size_t size, size_t nmemb, ResponseSink* sink);
+size_t headerCallback(char* buffer, size_t size, size_t nitems, ResponseSink* sink);
+std::string_view stripIpfsScheme(std::string_view hash);
+
 class IPFSClient {
 public:
+    static constexpr size_t EndpointCount = 5;
+    static constexpr size_t LatencyPhaseCount = 2;
+
     struct UploadStrategy {
         virtual ~UploadStrategy() = default;
         virtual Result<std::vector<std::string>> upload(IPFSClient& client, const std::vector<std::string>& files, const std::optional<Json::Value>& metadata) = 0;
     };
 
+    struct ClientStats {
+        BufferPoolStats responseBuffers;
+        uint64_t cacheBypassedBytes = 0;
+
+        struct RequestCount {
+            Endpoint endpoint;
+            long httpStatus;
+            uint64_t count;
+        };
+        std::vector<RequestCount> requests;
+        uint64_t bytesUploaded = 0;
+        uint64_t bytesDownloaded = 0;
+        uint64_t uploadRetries = 0;
+        uint64_t rateLimitWaits = 0;
+        double rateLimitWaitSeconds = 0.0;
+        uint64_t inFlightRequests = 0;
+    };
+
+    struct RequestTiming {
+        Endpoint endpoint = Endpoint::Gateway;
+        CURLcode result = CURLE_OK;
+        long httpStatus = 0;
+        int64_t nameLookupUs = 0;
+        int64_t connectUs = 0;
+        int64_t appConnectUs = 0;
+        int64_t preTransferUs = 0;
+        int64_t startTransferUs = 0;
+        int64_t totalUs = 0;
+        int64_t bytesUp = 0;
+        int64_t bytesDown = 0;
+        bool connectionReused = false;
+    };
+
     explicit IPFSClient(const Config& cfg);
     ~IPFSClient();
 
@@ -32,17 +110,69 @@ public:
     Result<std::string> retrieveContent(const std::string& ipfsHash);
     Result<Json::Value> listPins(const std::optional<std::string>& group = std::nullopt);
     Result<void> deletePin(const std::string& ipfsHash);
-    Result<Json::Value> parseJSON(const std::string& data);
+    static Result<Json::Value> parseJSON(const std::string& data);
+    static std::string serializeMetadata(const Json::Value& metadata);
     Result<std::string> performUpload(const std::string& filePath, const std::optional<Json::Value>& metadata, int retries = 2, std::chrono::seconds retryDelay = std::chrono::seconds(1));
     static std::string errorToString(const std::pair<IPFSError, std::string>& error);
+    ClientStats stats() const;
+    std::string accountDigest() const { return KeyCache::digest(config); }
+    RequestTiming lastTiming(Endpoint endpoint);
+    void setTimingCallback(std::function<void(const RequestTiming&)> callback);
+    LatencySnapshot latency(Endpoint endpoint, LatencyPhase phase) const;
+    static std::string_view endpointName(Endpoint endpoint);
+    static curl_slist* authHeaderList(const Config& config, bool multipart = false);
+    static std::string requestUrl(std::string_view baseUrl, std::initializer_list<std::string_view> urlSuffix);
 
 private:
+    static constexpr size_t StatusSlots = 600;
+
+    enum class KeyState { Unknown, Valid, Invalid };
+
+    struct EndpointHandle {
+        CURL* curl = nullptr;
+        std::string baseUrl;
+        std::mutex mutex;
+        BufferPool responsePool;
+        RequestTiming lastTiming;
+    };
+
     Config config;
-    CURL* curl;
-    std::mutex curlMutex;
+    CURL* templateHandle;
+    CURLSH* share = nullptr;
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> shareLocks;
+    curl_slist* authHeaders = nullptr;
+    curl_slist* uploadHeaders = nullptr;
+    curl_slist* resolveOverrides = nullptr;
+    std::unique_ptr<ConnectionCache> connectionCache;
+    std::array<EndpointHandle, EndpointCount> handles;
+    std::atomic<uint64_t> cacheBypassedBytes{0};
+    std::function<void(const RequestTiming&)> timingCallback;
+    std::array<std::array<LatencyHistogram, LatencyPhaseCount>, EndpointCount> latencyHistograms;
+    std::array<std::array<std::atomic<uint64_t>, StatusSlots>, EndpointCount> statusCounts{};
+    std::atomic<uint64_t> bytesUploaded{0};
+    std::atomic<uint64_t> bytesDownloaded{0};
+    std::atomic<uint64_t> uploadRetries{0};
+    std::atomic<uint64_t> rateLimitWaits{0};
+    std::atomic<uint64_t> rateLimitWaitMicros{0};
+    std::atomic<uint64_t> inFlightRequests{0};
+    std::atomic<KeyState> keyState{KeyState::Unknown};
+    std::mutex keyMutex;
+    std::string keyError;
+    std::shared_future<Result<void>> asyncValidation;
+    std::atomic<bool> prewarmStopping{false};
+    std::thread prewarmer;
 
-    Result<std::string> performCURLRequest(const std::string& url, const std::string& method, curl_mime* mime = nullptr);
+    EndpointHandle& handle(Endpoint endpoint) { return handles[static_cast<size_t>(endpoint)]; }
+    void setupEndpoint(Endpoint endpoint, std::string baseUrl);
+    Result<BufferPool::Lease> performCURLRequest(Endpoint endpoint, std::initializer_list<std::string_view> urlSuffix = {}, curl_mime* mime = nullptr, RequestTiming* timing = nullptr, Progress::Transfer* transfer = nullptr);
+    void waitBeforeRetry(const RequestTiming& timing, std::chrono::seconds delay);
+    void prewarm(std::vector<std::string> origins);
     void validateKeys();
+    Result<void> checkKeys();
+    Result<void> recheckKeys();
+    KeyCache keyCache() const;
+    void saveConnectionCache();
+    void releaseHandles();
 };
 
 class SingleFileStrategy : public IPFSClient::UploadStrategy {
@@ -59,19 +189,55 @@ public:
 
 class BatchFileStrategy : public IPFSClient::UploadStrategy {
 public:
+    explicit BatchFileStrategy(size_t prefetchWindow = Prefetcher::DefaultWindow, size_t prefetchBudget = Prefetcher::DefaultMemoryBudget)
+        : prefetchWindow(prefetchWindow), prefetchBudget(prefetchBudget) {}
+
     Result<std::vector<std::string>> upload(IPFSClient& client, const std::vector<std::string>& files, const std::optional<Json::Value>& metadata) override {
         std::vector<std::string> results;
-        for (const auto& file : files) {
+        Prefetcher prefetcher(files, prefetchWindow, prefetchBudget);
+        for (size_t i = 0; i < files.size(); ++i) {
+            const auto& file = files[i];
+            prefetcher.advance(i);
             auto result = client.performUpload(file, metadata);
             if (result) {
                 results.push_back(*result);
-                Logger::log(LogLevel::INFO, "Uploaded " + file + " to " + *result, true);
-            } else {
-                Logger::log(LogLevel::ERROR, "Failed to upload " + file + ": " + IPFSClient::errorToString(result.error()), true);
+                Logger::info("Uploaded {} to {}", file, *result);
+            } else if (Logger::enabled(LogLevel::ERROR)) {
+                Logger::error("Failed to upload {}: {}", file, IPFSClient::errorToString(result.error()));
             }
         }
+        if (Logger::enabled(LogLevel::DEBUG)) {
+            PrefetchStats prefetchStats = prefetcher.stats();
+            Logger::debug("Prefetched {} files ({} bytes)", prefetchStats.filesPrefetched, prefetchStats.bytesPrefetched);
+        }
         return results;
     }
+
+private:
+    size_t prefetchWindow;
+    size_t prefetchBudget;
+};
+
+class StreamingUploadStrategy : public IPFSClient::UploadStrategy {
+public:
+    using FileHandler = std::function<void(const std::string& file, const Result<std::string>& result)>;
+
+    explicit StreamingUploadStrategy(FileHandler onFile) : onFile(std::move(onFile)) {}
+
+    Result<std::vector<std::string>> upload(IPFSClient& client, const std::vector<std::string>& files, const std::optional<Json::Value>& metadata) override {
+        std::vector<std::string> results;
+        Prefetcher prefetcher(files);
+        for (size_t i = 0; i < files.size(); ++i) {
+            prefetcher.advance(i);
+            auto result = client.performUpload(files[i], metadata);
+            onFile(files[i], result);
+            if (result) results.push_back(*result);
+        }
+        return results;
+    }
+
+private:
+    FileHandler onFile;
 };
 
 #endif
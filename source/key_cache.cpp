@@ -0,0 +1,106 @@
+#include "key_cache.hpp"
+#include "logger.hpp"
+#include "private_file.hpp"
+#include "sha256.hpp"
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+
+namespace {
+
+constexpr size_t DigestKeyBytes = 32;
+
+int64_t unixNow() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string randomKey() {
+    std::random_device random;
+    std::string key(DigestKeyBytes, '\0');
+    for (char& byte : key) byte = static_cast<char>(random());
+    return key;
+}
+
+std::expected<std::string, std::string> readDigestKey(const std::filesystem::path& path) {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        std::ifstream file(path, std::ios::binary);
+        std::string key(std::istreambuf_iterator<char>(file), {});
+        if (key.size() == DigestKeyBytes) return key;
+        if (file.is_open()) return std::unexpected(path.string() + " is not a key validation digest key");
+        auto created = createPrivateFile(path, randomKey());
+        if (!created) return std::unexpected(created.error());
+    }
+    return std::unexpected("Could not read " + path.string());
+}
+
+std::string digestKey(const std::filesystem::path& path) {
+    auto key = readDigestKey(path);
+    if (key) return *key;
+    static const std::string processKey = randomKey();
+    Logger::warn("Using a per-process digest key, validated keys will not be remembered: {}", key.error());
+    return processKey;
+}
+
+}
+
+KeyCache::KeyCache(std::filesystem::path path, std::chrono::seconds ttl) : path(std::move(path)), ttl(ttl) {}
+
+std::string KeyCache::digest(const Config& config) {
+    std::string message = "pinatapipe key validation";
+    for (std::string_view part : {std::string_view(config.apiUrl), std::string_view(config.pinataApiKey), std::string_view(config.pinataSecret)}) {
+        message.append(1, '\0').append(part);
+    }
+    return Sha256::toHex(Sha256::hmac(digestKey(keyPath(config)), message));
+}
+
+std::filesystem::path KeyCache::defaultPath() {
+    return userCacheDirectory() / "validated-keys";
+}
+
+std::filesystem::path KeyCache::keyPath(const Config& config) {
+    std::filesystem::path path = config.keyCachePath.empty() ? defaultPath() : std::filesystem::path(config.keyCachePath);
+    path += ".key";
+    return path;
+}
+
+bool KeyCache::contains(std::string_view digest) const {
+    auto entries = load();
+    auto entry = entries.find(digest);
+    return entry != entries.end() && unixNow() - entry->second < ttl.count();
+}
+
+void KeyCache::store(std::string_view digest) {
+    auto entries = load();
+    entries.insert_or_assign(std::string(digest), unixNow());
+    save(entries);
+}
+
+void KeyCache::forget(std::string_view digest) {
+    auto entries = load();
+    if (auto entry = entries.find(digest); entry != entries.end()) {
+        entries.erase(entry);
+        save(entries);
+    }
+}
+
+std::map<std::string, int64_t, std::less<>> KeyCache::load() const {
+    std::map<std::string, int64_t, std::less<>> entries;
+    std::ifstream file(path);
+    std::string line;
+    int64_t now = unixNow();
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string digest;
+        int64_t validatedAt = 0;
+        if (fields >> digest >> validatedAt && now - validatedAt < ttl.count()) entries[digest] = validatedAt;
+    }
+    return entries;
+}
+
+void KeyCache::save(const std::map<std::string, int64_t, std::less<>>& entries) const {
+    std::string contents;
+    for (const auto& [digest, validatedAt] : entries) std::format_to(std::back_inserter(contents), "{} {}\n", digest, validatedAt);
+    if (auto written = writePrivateFile(path, contents); !written) Logger::warn("Could not update key validation cache: {}", written.error());
+}
@@ -0,0 +1,32 @@
+#ifndef KEY_CACHE_HPP
+#define KEY_CACHE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include "config.hpp"
+
+class KeyCache {
+public:
+    KeyCache(std::filesystem::path path, std::chrono::seconds ttl);
+
+    bool contains(std::string_view digest) const;
+    void store(std::string_view digest);
+    void forget(std::string_view digest);
+
+    static std::string digest(const Config& config);
+    static std::filesystem::path defaultPath();
+    static std::filesystem::path keyPath(const Config& config);
+
+private:
+    std::map<std::string, int64_t, std::less<>> load() const;
+    void save(const std::map<std::string, int64_t, std::less<>>& entries) const;
+
+    std::filesystem::path path;
+    std::chrono::seconds ttl;
+};
+
+#endif
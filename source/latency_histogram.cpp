@@ -0,0 +1,59 @@
+#include "latency_histogram.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+size_t LatencyHistogram::bucketIndex(uint64_t valueUs) {
+    if (valueUs < LinearBuckets) return static_cast<size_t>(valueUs);
+    unsigned magnitude = static_cast<unsigned>(std::bit_width(valueUs)) - 1;
+    if (magnitude >= MaxMagnitude) return BucketCount - 1;
+    unsigned shift = magnitude - SubBucketBits;
+    size_t sub = static_cast<size_t>(valueUs >> shift) - SubBuckets;
+    return LinearBuckets + (magnitude - SubBucketBits - 1) * SubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < LinearBuckets) return index;
+    size_t offset = index - LinearBuckets;
+    unsigned shift = static_cast<unsigned>(offset / SubBuckets) + 1;
+    uint64_t sub = SubBuckets + offset % SubBuckets;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t valueUs) {
+    counts[bucketIndex(valueUs)].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(valueUs, std::memory_order_relaxed);
+    uint64_t seen = max.load(std::memory_order_relaxed);
+    while (valueUs > seen && !max.compare_exchange_weak(seen, valueUs, std::memory_order_relaxed)) {
+    }
+}
+
+LatencySnapshot LatencyHistogram::snapshot() const {
+    LatencySnapshot result;
+    result.buckets.resize(BucketCount);
+    for (size_t i = 0; i < BucketCount; ++i) {
+        result.buckets[i] = counts[i].load(std::memory_order_relaxed);
+        result.count += result.buckets[i];
+    }
+    result.sumUs = sum.load(std::memory_order_relaxed);
+    result.maxUs = max.load(std::memory_order_relaxed);
+    return result;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& count : counts) count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencySnapshot::percentileUs(double percentile) const {
+    if (count == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(count)));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) return std::min(LatencyHistogram::bucketUpperBound(i), maxUs);
+    }
+    return maxUs;
+}
@@ -0,0 +1,41 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct LatencySnapshot {
+    uint64_t count = 0;
+    uint64_t sumUs = 0;
+    uint64_t maxUs = 0;
+    std::vector<uint64_t> buckets;
+
+    uint64_t percentileUs(double percentile) const;
+    double meanUs() const { return count ? static_cast<double>(sumUs) / static_cast<double>(count) : 0.0; }
+};
+
+class LatencyHistogram {
+public:
+    static constexpr unsigned SubBucketBits = 5;
+    static constexpr unsigned MaxMagnitude = 40;
+    static constexpr size_t LinearBuckets = size_t(1) << (SubBucketBits + 1);
+    static constexpr size_t SubBuckets = size_t(1) << SubBucketBits;
+    static constexpr size_t BucketCount = LinearBuckets + (MaxMagnitude - SubBucketBits - 1) * SubBuckets;
+
+    void record(uint64_t valueUs);
+    LatencySnapshot snapshot() const;
+    void reset();
+
+    static size_t bucketIndex(uint64_t valueUs);
+    static uint64_t bucketUpperBound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, BucketCount> counts{};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+};
+
+#endif
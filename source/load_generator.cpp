@@ -0,0 +1,194 @@
+#include "load_generator.hpp"
+#include "ipfs_client.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t PatternBytes = 1024 * 1024;
+
+double processCpuSeconds() {
+#ifdef _WIN32
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#else
+    rusage usage {};
+    ::getrusage(RUSAGE_SELF, &usage);
+    auto seconds = [](const timeval& tv) { return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6; };
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+#endif
+}
+
+long processId() {
+#ifdef _WIN32
+    return 0;
+#else
+    return static_cast<long>(::getpid());
+#endif
+}
+
+}
+
+LoadGenerator::LoadGenerator(const Config& config, LoadOptions options) : config(config), options(std::move(options)) {}
+
+LoadGenerator::~LoadGenerator() {
+    if (options.keepFiles) return;
+    std::error_code ec;
+    if (ownsDirectory) {
+        std::filesystem::remove_all(directory, ec);
+        return;
+    }
+    for (const auto& path : paths) std::filesystem::remove(path, ec);
+}
+
+std::optional<Workload> LoadGenerator::parseWorkload(std::string_view name) {
+    if (name == "small") return Workload::Small;
+    if (name == "lognormal") return Workload::LogNormal;
+    if (name == "huge") return Workload::Huge;
+    return std::nullopt;
+}
+
+std::string_view LoadGenerator::workloadName(Workload workload) {
+    switch (workload) {
+    case Workload::Small: return "small";
+    case Workload::LogNormal: return "lognormal";
+    case Workload::Huge: return "huge";
+    }
+    return "unknown";
+}
+
+std::vector<uint64_t> LoadGenerator::fileSizes(Workload workload, size_t fileCount, uint64_t hugeBytes, uint64_t seed) {
+    std::vector<uint64_t> sizes;
+    sizes.reserve(fileCount + HugeFileCount);
+    std::mt19937_64 rng(seed);
+    switch (workload) {
+    case Workload::Small:
+        sizes.assign(fileCount, SmallFileBytes);
+        break;
+    case Workload::LogNormal: {
+        std::lognormal_distribution<double> distribution(std::log(LogNormalMedianBytes), LogNormalSigma);
+        for (size_t i = 0; i < fileCount; ++i) {
+            double size = std::clamp(distribution(rng), 1.0, static_cast<double>(LogNormalMaxBytes));
+            sizes.push_back(static_cast<uint64_t>(size));
+        }
+        break;
+    }
+    case Workload::Huge: {
+        sizes.assign(fileCount, SmallFileBytes);
+        size_t stride = fileCount / HugeFileCount + 1;
+        for (size_t i = 0; i < HugeFileCount; ++i) sizes.insert(sizes.begin() + static_cast<std::ptrdiff_t>(std::min(sizes.size(), i * stride)), hugeBytes);
+        break;
+    }
+    }
+    return sizes;
+}
+
+std::expected<void, std::string> LoadGenerator::prepare() {
+    std::error_code ec;
+    directory = options.directory;
+    if (directory.empty()) {
+        directory = std::filesystem::temp_directory_path(ec) / ("pinatapipe-bench-" + std::to_string(processId()));
+        if (ec) return std::unexpected("Could not locate a temporary directory: " + ec.message());
+        ownsDirectory = true;
+    }
+    std::filesystem::create_directories(directory, ec);
+    if (ec) return std::unexpected("Could not create " + directory.string() + ": " + ec.message());
+
+    std::vector<char> pattern(PatternBytes);
+    std::mt19937_64 rng(options.seed);
+    for (size_t i = 0; i < pattern.size(); i += sizeof(uint64_t)) {
+        uint64_t word = rng();
+        std::memcpy(pattern.data() + i, &word, sizeof(word));
+    }
+
+    std::vector<uint64_t> sizes = fileSizes(options.workload, options.fileCount, options.hugeBytes, options.seed);
+    paths.reserve(sizes.size());
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        auto path = directory / std::format("{}-{:06}.bin", workloadName(options.workload), i);
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return std::unexpected("Could not create " + path.string());
+        paths.push_back(path.string());
+
+        uint64_t header = i;
+        uint64_t remaining = sizes[i];
+        size_t headerBytes = static_cast<size_t>(std::min<uint64_t>(remaining, sizeof(header)));
+        out.write(reinterpret_cast<const char*>(&header), static_cast<std::streamsize>(headerBytes));
+        remaining -= headerBytes;
+        while (remaining > 0) {
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(remaining, pattern.size()));
+            out.write(pattern.data(), static_cast<std::streamsize>(chunk));
+            remaining -= chunk;
+        }
+        if (!out) return std::unexpected("Could not write " + path.string());
+        bytes += sizes[i];
+    }
+    Logger::info("Generated {} {} files ({} bytes) in {}", paths.size(), workloadName(options.workload), bytes, directory.string());
+    return {};
+}
+
+LoadResult LoadGenerator::run(size_t concurrency) {
+    concurrency = std::max<size_t>(1, concurrency);
+    std::vector<std::unique_ptr<IPFSClient>> clients;
+    clients.reserve(concurrency);
+    for (size_t i = 0; i < concurrency; ++i) clients.push_back(std::make_unique<IPFSClient>(config));
+
+    std::vector<uint64_t> sizes(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        std::error_code ec;
+        sizes[i] = std::filesystem::file_size(paths[i], ec);
+    }
+
+    Json::Value metadata(Json::objectValue);
+    metadata["name"] = "pinatapipe-bench";
+    LatencyHistogram latency;
+    std::atomic<size_t> next{0};
+    std::atomic<uint64_t> uploaded{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> sent{0};
+
+    double cpuStart = processCpuSeconds();
+    auto wallStart = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    workers.reserve(concurrency);
+    for (auto& client : clients) {
+        workers.emplace_back([&, client = client.get()] {
+            std::optional<Json::Value> fileMetadata = metadata;
+            for (size_t index = next.fetch_add(1, std::memory_order_relaxed); index < paths.size(); index = next.fetch_add(1, std::memory_order_relaxed)) {
+                auto start = std::chrono::steady_clock::now();
+                auto result = client->upload({paths[index]}, fileMetadata);
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                latency.record(static_cast<uint64_t>(elapsed.count()));
+                if (result) {
+                    uploaded.fetch_add(1, std::memory_order_relaxed);
+                    sent.fetch_add(sizes[index], std::memory_order_relaxed);
+                } else {
+                    failed.fetch_add(1, std::memory_order_relaxed);
+                    Logger::warn("Bench upload of {} failed: {}", paths[index], IPFSClient::errorToString(result.error()));
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    LoadResult result;
+    result.concurrency = concurrency;
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    result.cpuSeconds = processCpuSeconds() - cpuStart;
+    result.filesUploaded = uploaded.load();
+    result.filesFailed = failed.load();
+    result.bytesUploaded = sent.load();
+    result.latency = latency.snapshot();
+    return result;
+}
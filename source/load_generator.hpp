@@ -0,0 +1,73 @@
+#ifndef LOAD_GENERATOR_HPP
+#define LOAD_GENERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "config.hpp"
+#include "latency_histogram.hpp"
+
+enum class Workload { Small, LogNormal, Huge };
+
+struct LoadOptions {
+    Workload workload = Workload::Small;
+    size_t fileCount = 200;
+    std::vector<size_t> concurrency{1, 4, 16};
+    uint64_t hugeBytes = 256ull * 1024 * 1024;
+    uint64_t seed = 1;
+    std::filesystem::path directory;
+    bool keepFiles = false;
+};
+
+struct LoadResult {
+    size_t concurrency = 0;
+    uint64_t filesUploaded = 0;
+    uint64_t filesFailed = 0;
+    uint64_t bytesUploaded = 0;
+    double wallSeconds = 0.0;
+    double cpuSeconds = 0.0;
+    LatencySnapshot latency;
+
+    double filesPerSecond() const { return wallSeconds > 0 ? static_cast<double>(filesUploaded) / wallSeconds : 0.0; }
+    double megabytesPerSecond() const { return wallSeconds > 0 ? static_cast<double>(bytesUploaded) / (1024.0 * 1024.0) / wallSeconds : 0.0; }
+    double cpuSecondsPerGigabyte() const { return bytesUploaded ? cpuSeconds / (static_cast<double>(bytesUploaded) / (1024.0 * 1024.0 * 1024.0)) : 0.0; }
+};
+
+class LoadGenerator {
+public:
+    static constexpr size_t SmallFileBytes = 4096;
+    static constexpr double LogNormalMedianBytes = 64.0 * 1024;
+    static constexpr double LogNormalSigma = 1.5;
+    static constexpr uint64_t LogNormalMaxBytes = 64ull * 1024 * 1024;
+    static constexpr size_t HugeFileCount = 3;
+
+    LoadGenerator(const Config& config, LoadOptions options);
+    LoadGenerator(const LoadGenerator&) = delete;
+    LoadGenerator& operator=(const LoadGenerator&) = delete;
+    ~LoadGenerator();
+
+    std::expected<void, std::string> prepare();
+    LoadResult run(size_t concurrency);
+
+    const std::vector<std::string>& files() const { return paths; }
+    uint64_t totalBytes() const { return bytes; }
+
+    static std::optional<Workload> parseWorkload(std::string_view name);
+    static std::string_view workloadName(Workload workload);
+    static std::vector<uint64_t> fileSizes(Workload workload, size_t fileCount, uint64_t hugeBytes, uint64_t seed);
+
+private:
+    Config config;
+    LoadOptions options;
+    std::filesystem::path directory;
+    bool ownsDirectory = false;
+    std::vector<std::string> paths;
+    uint64_t bytes = 0;
+};
+
+#endif
@@ -1,45 +1,262 @@
 #include "logger.hpp"
+#include "trace.hpp"
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
 
-bool Logger::verboseMode = false;
-std::mutex Logger::logMutex;
-std::function<void(double, double, double)> Logger::progressCallback = nullptr;
-double Logger::lastProgress = -1.0;
-bool Logger::progressComplete = false;
-std::chrono::steady_clock::time_point Logger::lastUpdateTime = std::chrono::steady_clock::now();
-double Logger::lastUploadedBytes = 0.0;
+namespace {
+
+struct LogRecord {
+    std::atomic<size_t> sequence{0};
+    LogLevel level = LogLevel::INFO;
+    std::chrono::system_clock::time_point time;
+    std::string text;
+};
 
-void Logger::log(LogLevel level, const std::string& message, bool verbose) {
-    if (!verbose || verboseMode) {
-        std::lock_guard<std::mutex> lock(logMutex);
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-        std::string timestamp = std::format("[{:%Y-%m-%d %H:%M:%S}] ", std::chrono::system_clock::from_time_t(time));
-        std::string prefix = (level == LogLevel::ERROR) ? "\033[31m[ERROR]\033[0m " : "\033[32m[INFO]\033[0m ";
-        std::print(stderr, "{}{}{}\n", timestamp, prefix, message);
+class LogBackend;
+LogBackend& backend();
+
+std::string_view levelPrefix(LogLevel level) {
+    switch (level) {
+    case LogLevel::TRACE: return "\033[90m[TRACE]\033[0m ";
+    case LogLevel::DEBUG: return "\033[36m[DEBUG]\033[0m ";
+    case LogLevel::INFO: return "\033[32m[INFO]\033[0m ";
+    case LogLevel::WARN: return "\033[33m[WARN]\033[0m ";
+    case LogLevel::ERROR: return "\033[31m[ERROR]\033[0m ";
     }
+    return "";
 }
 
-void Logger::setProgressCallback(std::function<void(double, double, double)> cb) {
-    std::lock_guard<std::mutex> lock(logMutex);
-    progressCallback = cb;
-}
+class LogBackend {
+public:
+    void configure(size_t queueCapacity, LogOverflow overflowMode) {
+        std::lock_guard<std::mutex> lock(startMutex);
+        overflow.store(overflowMode, std::memory_order_relaxed);
+        if (!started) capacity = queueCapacity;
+    }
+
+    void push(LogLevel level, std::string_view fmt, std::format_args args) {
+        auto time = std::chrono::system_clock::now();
+        if (!ensureStarted()) {
+            std::string line;
+            std::lock_guard<std::mutex> lock(directMutex);
+            appendLine(line, level, time, std::vformat(fmt, args));
+            std::fwrite(line.data(), 1, line.size(), output);
+            return;
+        }
 
-void Logger::reportProgress(double percent, double speed, double eta) {
-    if (progressCallback && verboseMode && percent >= 0 && percent <= 100 && !progressComplete) {
-        std::lock_guard<std::mutex> lock(logMutex);
-        if (lastProgress < 0 || percent >= lastProgress + 1.0 || percent == 100.0) {
-            progressCallback(percent, speed, eta);
-            lastProgress = percent;
-            if (percent == 100.0) progressComplete = true;
+        while (!tryPush(level, time, fmt, args)) {
+            if (overflow.load(std::memory_order_relaxed) == LogOverflow::Drop) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            size_t seen = consumed.load(std::memory_order_acquire);
+            wakeWriter();
+            if (!tryPush(level, time, fmt, args)) consumed.wait(seen, std::memory_order_acquire);
+            else break;
         }
+        pending.fetch_add(1, std::memory_order_seq_cst);
+        if (writerSleeping.load(std::memory_order_seq_cst)) pending.notify_one();
     }
+
+    void flush() {
+        if (!running.load(std::memory_order_acquire)) return;
+        size_t target = enqueuePos.load(std::memory_order_acquire);
+        wakeWriter();
+        for (size_t seen = consumed.load(std::memory_order_acquire); seen < target; seen = consumed.load(std::memory_order_acquire)) {
+            consumed.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(startMutex);
+            if (!running.load(std::memory_order_acquire)) return;
+            stopping.store(true, std::memory_order_release);
+        }
+        wakeWriter();
+        writer.join();
+        running.store(false, std::memory_order_release);
+    }
+
+    void setOutput(std::FILE* file) {
+        std::lock_guard<std::mutex> lock(directMutex);
+        output = file;
+    }
+
+    uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    bool ensureStarted() {
+        if (running.load(std::memory_order_acquire)) return true;
+        std::lock_guard<std::mutex> lock(startMutex);
+        if (started) return running.load(std::memory_order_acquire);
+        started = true;
+        size_t rounded = 1;
+        while (rounded < capacity) rounded <<= 1;
+        capacity = rounded;
+        slots = std::make_unique<LogRecord[]>(capacity);
+        for (size_t i = 0; i < capacity; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+        writer = std::thread(&LogBackend::run, this);
+        running.store(true, std::memory_order_release);
+        std::atexit([] { backend().stop(); });
+        return true;
+    }
+
+    bool tryPush(LogLevel level, std::chrono::system_clock::time_point time, std::string_view fmt, std::format_args args) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            LogRecord& slot = slots[pos & (capacity - 1)];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.level = level;
+                    slot.time = time;
+                    try {
+                        std::vformat_to(std::back_inserter(slot.text), fmt, args);
+                    } catch (...) {
+                        slot.text.clear();
+                        slot.sequence.store(pos + 1, std::memory_order_release);
+                        throw;
+                    }
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void wakeWriter() {
+        pending.fetch_add(1, std::memory_order_seq_cst);
+        pending.notify_one();
+    }
+
+    void run() {
+        std::string batch;
+        size_t dequeuePos = 0;
+        for (;;) {
+            writerSleeping.store(true, std::memory_order_seq_cst);
+            uint32_t seen = pending.load(std::memory_order_seq_cst);
+            size_t drained = drain(batch, dequeuePos);
+            if (drained == 0) {
+                if (stopping.load(std::memory_order_acquire)) break;
+                pending.wait(seen, std::memory_order_seq_cst);
+            }
+            writerSleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    size_t drain(std::string& batch, size_t& dequeuePos) {
+        size_t drained = 0;
+        for (;;) {
+            LogRecord& slot = slots[dequeuePos & (capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) break;
+            if (!slot.text.empty()) appendLine(batch, slot.level, slot.time, slot.text);
+            slot.text.clear();
+            slot.sequence.store(dequeuePos + capacity, std::memory_order_release);
+            ++dequeuePos;
+            ++drained;
+            if (batch.size() >= 64 * 1024) writeBatch(batch, dequeuePos);
+        }
+        if (!batch.empty() || consumed.load(std::memory_order_relaxed) != dequeuePos) writeBatch(batch, dequeuePos);
+        return drained;
+    }
+
+    void writeBatch(std::string& batch, size_t dequeuePos) {
+        Trace::Span span("log write", "logger");
+        {
+            std::lock_guard<std::mutex> lock(directMutex);
+            std::fwrite(batch.data(), 1, batch.size(), output);
+            std::fflush(output);
+        }
+        batch.clear();
+        consumed.store(dequeuePos, std::memory_order_release);
+        consumed.notify_all();
+    }
+
+    void appendLine(std::string& out, LogLevel level, std::chrono::system_clock::time_point time, std::string_view message) {
+        auto seconds = std::chrono::floor<std::chrono::seconds>(time);
+        if (seconds != lastTimestampSecond || lastTimestamp.empty()) {
+            lastTimestampSecond = seconds;
+            lastTimestamp = std::format("[{:%Y-%m-%d %H:%M:%S}] ", seconds);
+        }
+        out += lastTimestamp;
+        out += levelPrefix(level);
+        out += message;
+        out += '\n';
+    }
+
+    std::mutex startMutex;
+    std::mutex directMutex;
+    std::FILE* output = stderr;
+    bool started = false;
+    size_t capacity = Logger::DefaultQueueCapacity;
+    std::unique_ptr<LogRecord[]> slots;
+    std::thread writer;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopping{false};
+    std::atomic<LogOverflow> overflow{LogOverflow::Block};
+    std::atomic<uint64_t> dropped{0};
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> consumed{0};
+    alignas(64) std::atomic<uint32_t> pending{0};
+    std::atomic<bool> writerSleeping{false};
+    std::chrono::sys_seconds lastTimestampSecond;
+    std::string lastTimestamp;
+};
+
+LogBackend& backend() {
+    static LogBackend instance;
+    return instance;
+}
+
+}
+
+bool Logger::verboseMode = false;
+std::atomic<LogLevel> Logger::minLevel{LogLevel::DEBUG};
+
+void Logger::write(LogLevel level, std::string_view fmt, std::format_args args) {
+    backend().push(level, fmt, args);
+}
+
+std::optional<LogLevel> Logger::parseLevel(std::string_view name) {
+    if (name == "trace") return LogLevel::TRACE;
+    if (name == "debug") return LogLevel::DEBUG;
+    if (name == "info") return LogLevel::INFO;
+    if (name == "warn") return LogLevel::WARN;
+    if (name == "error") return LogLevel::ERROR;
+    return std::nullopt;
+}
+
+std::optional<LogOverflow> Logger::parseOverflow(std::string_view name) {
+    if (name == "drop") return LogOverflow::Drop;
+    if (name == "block") return LogOverflow::Block;
+    return std::nullopt;
+}
+
+void Logger::configure(size_t queueCapacity, LogOverflow overflow) {
+    backend().configure(queueCapacity, overflow);
+}
+
+void Logger::setOutput(std::FILE* file) {
+    backend().setOutput(file);
+}
+
+void Logger::flush() {
+    Trace::Span span("Logger::flush", "logger");
+    backend().flush();
 }
 
-void Logger::resetProgress() {
-    std::lock_guard<std::mutex> lock(logMutex);
-    lastProgress = -1.0;
-    progressComplete = false;
-    lastUpdateTime = std::chrono::steady_clock::now();
-    lastUploadedBytes = 0.0;
+uint64_t Logger::droppedCount() {
+    return backend().droppedCount();
 }
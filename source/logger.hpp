@@ -1,31 +1,59 @@
 #ifndef LOGGER_HPP
 #define LOGGER_HPP
 
+#include <atomic>
 #include <print>
 #include <string>
-#include <chrono>
+#include <string_view>
+#include <cstdint>
+#include <cstdio>
 #include <format>
-#include <functional>
-#include <mutex>
+#include <optional>
 
-enum class LogLevel { INFO, ERROR };
+#ifndef PINATAPIPE_LOG_MIN_LEVEL
+#define PINATAPIPE_LOG_MIN_LEVEL 0
+#endif
+
+enum class LogLevel { TRACE, DEBUG, INFO, WARN, ERROR };
+enum class LogOverflow { Drop, Block };
 
 class Logger {
 public:
-    static void log(LogLevel level, const std::string& message, bool verbose = false);
-    static void setProgressCallback(std::function<void(double, double, double)> cb);
-    static void reportProgress(double percent, double speed, double eta);
-    static void resetProgress();
+    static constexpr size_t DefaultQueueCapacity = 4096;
+    static constexpr LogLevel CompiledMinLevel = static_cast<LogLevel>(PINATAPIPE_LOG_MIN_LEVEL);
+
+    template<LogLevel Level, typename... Args>
+    static void log(std::format_string<Args...> fmt, Args&&... args) {
+        if constexpr (Level >= CompiledMinLevel) {
+            if (enabled(Level)) write(Level, fmt.get(), std::make_format_args(args...));
+        }
+    }
+    template<typename... Args>
+    static void trace(std::format_string<Args...> fmt, Args&&... args) { log<LogLevel::TRACE>(fmt, std::forward<Args>(args)...); }
+    template<typename... Args>
+    static void debug(std::format_string<Args...> fmt, Args&&... args) { log<LogLevel::DEBUG>(fmt, std::forward<Args>(args)...); }
+    template<typename... Args>
+    static void info(std::format_string<Args...> fmt, Args&&... args) { log<LogLevel::INFO>(fmt, std::forward<Args>(args)...); }
+    template<typename... Args>
+    static void warn(std::format_string<Args...> fmt, Args&&... args) { log<LogLevel::WARN>(fmt, std::forward<Args>(args)...); }
+    template<typename... Args>
+    static void error(std::format_string<Args...> fmt, Args&&... args) { log<LogLevel::ERROR>(fmt, std::forward<Args>(args)...); }
+
+    static bool enabled(LogLevel level) { return level >= CompiledMinLevel && verboseMode && level >= minLevel.load(std::memory_order_relaxed); }
+    static void setLevel(LogLevel level) { minLevel.store(level, std::memory_order_relaxed); }
+    static std::optional<LogLevel> parseLevel(std::string_view name);
+    static std::optional<LogOverflow> parseOverflow(std::string_view name);
+    static void configure(size_t queueCapacity, LogOverflow overflow);
+    static void setOutput(std::FILE* file);
+    static void flush();
+    static uint64_t droppedCount();
 
     static bool verboseMode;
 
 private:
-    static std::mutex logMutex;
-    static std::function<void(double, double, double)> progressCallback;
-    static double lastProgress;
-    static bool progressComplete;
-    static std::chrono::steady_clock::time_point lastUpdateTime;
-    static double lastUploadedBytes;
+    static void write(LogLevel level, std::string_view fmt, std::format_args args);
+
+    static std::atomic<LogLevel> minLevel;
 };
 
 #endif
@@ -0,0 +1,118 @@
+#include "metrics_exporter.hpp"
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <format>
+#include <iterator>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::array<double, 15> LatencyBoundsSeconds{0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 120, 300};
+
+long processId() {
+#ifdef _WIN32
+    return _getpid();
+#else
+    return static_cast<long>(::getpid());
+#endif
+}
+
+void appendHistogram(std::string& out, std::string_view endpoint, std::string_view phase, const LatencySnapshot& snapshot) {
+    auto it = std::back_inserter(out);
+    size_t bucket = 0;
+    uint64_t cumulative = 0;
+    for (double bound : LatencyBoundsSeconds) {
+        auto boundUs = static_cast<uint64_t>(bound * 1e6);
+        while (bucket < snapshot.buckets.size() && LatencyHistogram::bucketUpperBound(bucket) <= boundUs) cumulative += snapshot.buckets[bucket++];
+        std::format_to(it, "pinatapipe_request_duration_seconds_bucket{{endpoint=\"{}\",phase=\"{}\",le=\"{}\"}} {}\n", endpoint, phase, bound, cumulative);
+    }
+    std::format_to(it, "pinatapipe_request_duration_seconds_bucket{{endpoint=\"{}\",phase=\"{}\",le=\"+Inf\"}} {}\n", endpoint, phase, snapshot.count);
+    std::format_to(it, "pinatapipe_request_duration_seconds_sum{{endpoint=\"{}\",phase=\"{}\"}} {}\n", endpoint, phase, static_cast<double>(snapshot.sumUs) / 1e6);
+    std::format_to(it, "pinatapipe_request_duration_seconds_count{{endpoint=\"{}\",phase=\"{}\"}} {}\n", endpoint, phase, snapshot.count);
+}
+
+}
+
+MetricsExporter::MetricsExporter(const IPFSClient& client, std::string path, std::chrono::seconds interval)
+    : client(client), path(std::move(path)), interval(interval) {
+    worker = std::thread(&MetricsExporter::run, this);
+}
+
+MetricsExporter::~MetricsExporter() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+    auto written = writeNow();
+    if (!written) Logger::warn("{}", written.error());
+}
+
+void MetricsExporter::run() {
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+        lock.unlock();
+        auto written = writeNow();
+        if (!written) Logger::warn("{}", written.error());
+        lock.lock();
+    }
+}
+
+std::string MetricsExporter::render() const {
+    IPFSClient::ClientStats stats = client.stats();
+    ProgressSnapshot progress = Progress::snapshot();
+    std::string out;
+    auto it = std::back_inserter(out);
+
+    out += "# TYPE pinatapipe_requests counter\n# HELP pinatapipe_requests HTTP requests by endpoint and status (status=\"error\" when no response was received).\n";
+    for (const auto& request : stats.requests) {
+        if (request.httpStatus == 0) std::format_to(it, "pinatapipe_requests_total{{endpoint=\"{}\",status=\"error\"}} {}\n", IPFSClient::endpointName(request.endpoint), request.count);
+        else std::format_to(it, "pinatapipe_requests_total{{endpoint=\"{}\",status=\"{}\"}} {}\n", IPFSClient::endpointName(request.endpoint), request.httpStatus, request.count);
+    }
+    std::format_to(it, "# TYPE pinatapipe_uploaded_bytes counter\n# UNIT pinatapipe_uploaded_bytes bytes\npinatapipe_uploaded_bytes_total {}\n", stats.bytesUploaded);
+    std::format_to(it, "# TYPE pinatapipe_downloaded_bytes counter\n# UNIT pinatapipe_downloaded_bytes bytes\npinatapipe_downloaded_bytes_total {}\n", stats.bytesDownloaded);
+    std::format_to(it, "# TYPE pinatapipe_cache_bypassed_bytes counter\n# UNIT pinatapipe_cache_bypassed_bytes bytes\npinatapipe_cache_bypassed_bytes_total {}\n", stats.cacheBypassedBytes);
+    std::format_to(it, "# TYPE pinatapipe_upload_retries counter\npinatapipe_upload_retries_total {}\n", stats.uploadRetries);
+    std::format_to(it, "# TYPE pinatapipe_rate_limit_waits counter\npinatapipe_rate_limit_waits_total {}\n", stats.rateLimitWaits);
+    std::format_to(it, "# TYPE pinatapipe_rate_limit_wait_seconds counter\n# UNIT pinatapipe_rate_limit_wait_seconds seconds\npinatapipe_rate_limit_wait_seconds_total {}\n", stats.rateLimitWaitSeconds);
+    std::format_to(it, "# TYPE pinatapipe_files_uploaded counter\npinatapipe_files_uploaded_total {}\n", progress.filesDone);
+    std::format_to(it, "# TYPE pinatapipe_files_failed counter\npinatapipe_files_failed_total {}\n", progress.filesFailed);
+    std::format_to(it, "# TYPE pinatapipe_in_flight_requests gauge\npinatapipe_in_flight_requests {}\n", stats.inFlightRequests);
+    std::format_to(it, "# TYPE pinatapipe_active_uploads gauge\npinatapipe_active_uploads {}\n", progress.activeTransfers);
+    uint64_t finished = progress.filesDone + progress.filesFailed + progress.activeTransfers;
+    std::format_to(it, "# TYPE pinatapipe_upload_queue_depth gauge\npinatapipe_upload_queue_depth {}\n", progress.filesTotal > finished ? progress.filesTotal - finished : 0);
+
+    out += "# TYPE pinatapipe_request_duration_seconds histogram\n# UNIT pinatapipe_request_duration_seconds seconds\n";
+    for (size_t i = 0; i < IPFSClient::EndpointCount; ++i) {
+        auto endpoint = static_cast<Endpoint>(i);
+        LatencySnapshot ttfb = client.latency(endpoint, LatencyPhase::TimeToFirstByte);
+        if (ttfb.count == 0) continue;
+        appendHistogram(out, IPFSClient::endpointName(endpoint), "ttfb", ttfb);
+        appendHistogram(out, IPFSClient::endpointName(endpoint), "total", client.latency(endpoint, LatencyPhase::Total));
+    }
+    out += "# EOF\n";
+    return out;
+}
+
+std::expected<void, std::string> MetricsExporter::writeNow() {
+    std::string body = render();
+    std::string temporary = std::format("{}.tmp.{}", path, processId());
+    std::FILE* file = std::fopen(temporary.c_str(), "w");
+    if (!file) return std::unexpected("Could not write metrics to " + temporary + ": " + std::strerror(errno));
+    bool ok = std::fwrite(body.data(), 1, body.size(), file) == body.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::string error = "Could not write metrics to " + path + ": " + std::strerror(errno);
+        std::remove(temporary.c_str());
+        return std::unexpected(error);
+    }
+    return {};
+}
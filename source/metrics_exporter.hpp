@@ -0,0 +1,36 @@
+#ifndef METRICS_EXPORTER_HPP
+#define METRICS_EXPORTER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <expected>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "ipfs_client.hpp"
+
+class MetricsExporter {
+public:
+    static constexpr std::chrono::seconds DefaultInterval{15};
+
+    MetricsExporter(const IPFSClient& client, std::string path, std::chrono::seconds interval = DefaultInterval);
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+    ~MetricsExporter();
+
+    std::expected<void, std::string> writeNow();
+    std::string render() const;
+
+private:
+    void run();
+
+    const IPFSClient& client;
+    std::string path;
+    std::chrono::seconds interval;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "prefetcher.hpp"
+#include "trace.hpp"
+#include <algorithm>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Prefetcher::Prefetcher(const std::vector<std::string>& files, size_t window, size_t memoryBudget)
+    : files(files), window(window), memoryBudget(memoryBudget), charged(files.size(), 0) {
+    if (window > 0 && files.size() > 1) worker = std::thread(&Prefetcher::run, this);
+}
+
+Prefetcher::~Prefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void Prefetcher::advance(size_t index) {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        for (size_t i = current; i < index && i < charged.size(); ++i) {
+            bytesInFlight -= charged[i];
+            charged[i] = 0;
+        }
+        current = std::max(current, index);
+    }
+    wake.notify_all();
+}
+
+PrefetchStats Prefetcher::stats() const {
+    PrefetchStats result;
+    result.filesPrefetched = filesPrefetched.load(std::memory_order_relaxed);
+    result.bytesPrefetched = bytesPrefetched.load(std::memory_order_relaxed);
+    result.budgetStalls = budgetStalls.load(std::memory_order_relaxed);
+    return result;
+}
+
+void Prefetcher::run() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    while (!stopping) {
+        next = std::max(next, current + 1);
+        if (next >= files.size()) break;
+        if (next > current + window) {
+            wake.wait(lock);
+            continue;
+        }
+        size_t allowance = std::min(MaxReadaheadPerFile, memoryBudget - std::min(memoryBudget, bytesInFlight));
+        if (allowance == 0) {
+            budgetStalls.fetch_add(1, std::memory_order_relaxed);
+            wake.wait(lock);
+            continue;
+        }
+
+        size_t index = next++;
+        lock.unlock();
+        size_t bytes = prefetch(files[index], allowance);
+        lock.lock();
+        if (index >= current) {
+            charged[index] = bytes;
+            bytesInFlight += bytes;
+        }
+    }
+}
+
+size_t Prefetcher::prefetch(const std::string& path, size_t allowance) {
+    Trace::Span span("prefetch", "io", path);
+#ifdef _WIN32
+    (void)path;
+    (void)allowance;
+    return 0;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    struct stat info {};
+    size_t bytes = 0;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        bytes = std::min(static_cast<size_t>(info.st_size), allowance);
+#if defined(__linux__)
+        ::readahead(fd, 0, bytes);
+#elif defined(POSIX_FADV_WILLNEED)
+        ::posix_fadvise(fd, 0, static_cast<off_t>(bytes), POSIX_FADV_WILLNEED);
+#endif
+        filesPrefetched.fetch_add(1, std::memory_order_relaxed);
+        bytesPrefetched.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    ::close(fd);
+    return bytes;
+#endif
+}
@@ -0,0 +1,55 @@
+#ifndef PREFETCHER_HPP
+#define PREFETCHER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct PrefetchStats {
+    uint64_t filesPrefetched = 0;
+    uint64_t bytesPrefetched = 0;
+    uint64_t budgetStalls = 0;
+};
+
+class Prefetcher {
+public:
+    static constexpr size_t DefaultWindow = 4;
+    static constexpr size_t DefaultMemoryBudget = 256 * 1024 * 1024;
+    static constexpr size_t MaxReadaheadPerFile = 64 * 1024 * 1024;
+
+    explicit Prefetcher(const std::vector<std::string>& files, size_t window = DefaultWindow, size_t memoryBudget = DefaultMemoryBudget);
+    Prefetcher(const Prefetcher&) = delete;
+    Prefetcher& operator=(const Prefetcher&) = delete;
+    ~Prefetcher();
+
+    void advance(size_t index);
+    PrefetchStats stats() const;
+
+private:
+    void run();
+    size_t prefetch(const std::string& path, size_t allowance);
+
+    const std::vector<std::string>& files;
+    size_t window;
+    size_t memoryBudget;
+    std::vector<size_t> charged;
+
+    mutable std::mutex stateMutex;
+    std::condition_variable wake;
+    size_t current = 0;
+    size_t next = 0;
+    size_t bytesInFlight = 0;
+    bool stopping = false;
+
+    std::atomic<uint64_t> filesPrefetched{0};
+    std::atomic<uint64_t> bytesPrefetched{0};
+    std::atomic<uint64_t> budgetStalls{0};
+    std::thread worker;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#include "private_file.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::expected<std::filesystem::path, std::string> writeTemporary(const std::filesystem::path& path, std::string_view contents) {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    std::filesystem::path temporary = path;
+#ifdef _WIN32
+    temporary += ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    bool written = file.write(contents.data(), static_cast<std::streamsize>(contents.size())) && (file.close(), !file.fail());
+#else
+    temporary += ".tmp." + std::to_string(::getpid());
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    bool written = fd >= 0 && ::write(fd, contents.data(), contents.size()) == static_cast<ssize_t>(contents.size());
+    if (fd >= 0) written = ::close(fd) == 0 && written;
+#endif
+    if (!written) {
+        std::string error = "Could not write " + temporary.string() + ": " + std::strerror(errno);
+        std::filesystem::remove(temporary, ec);
+        return std::unexpected(error);
+    }
+    return temporary;
+}
+
+}
+
+std::expected<void, std::string> writePrivateFile(const std::filesystem::path& path, std::string_view contents) {
+    auto temporary = writeTemporary(path, contents);
+    if (!temporary) return std::unexpected(temporary.error());
+    std::error_code ec;
+    std::filesystem::rename(*temporary, path, ec);
+    if (ec) return std::unexpected("Could not replace " + path.string() + ": " + ec.message());
+    return {};
+}
+
+std::expected<bool, std::string> createPrivateFile(const std::filesystem::path& path, std::string_view contents) {
+    auto temporary = writeTemporary(path, contents);
+    if (!temporary) return std::unexpected(temporary.error());
+    std::error_code ec;
+#ifdef _WIN32
+    bool created = !std::filesystem::exists(path, ec);
+    if (created) std::filesystem::rename(*temporary, path, ec);
+    else std::filesystem::remove(*temporary, ec);
+    if (ec) return std::unexpected("Could not create " + path.string() + ": " + ec.message());
+    return created;
+#else
+    int linked = ::link(temporary->c_str(), path.c_str());
+    int error = errno;
+    std::filesystem::remove(*temporary, ec);
+    if (linked == 0) return true;
+    if (error == EEXIST) return false;
+    return std::unexpected("Could not create " + path.string() + ": " + std::strerror(error));
+#endif
+}
+
+std::filesystem::path userCacheDirectory() {
+    if (const char* cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome && *cacheHome) return std::filesystem::path(cacheHome) / "pinatapipe";
+    if (const char* home = std::getenv("HOME"); home && *home) return std::filesystem::path(home) / ".cache" / "pinatapipe";
+    return std::filesystem::temp_directory_path() / "pinatapipe";
+}
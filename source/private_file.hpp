@@ -0,0 +1,13 @@
+#ifndef PRIVATE_FILE_HPP
+#define PRIVATE_FILE_HPP
+
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+std::expected<void, std::string> writePrivateFile(const std::filesystem::path& path, std::string_view contents);
+std::expected<bool, std::string> createPrivateFile(const std::filesystem::path& path, std::string_view contents);
+std::filesystem::path userCacheDirectory();
+
+#endif
@@ -0,0 +1,136 @@
+#include "progress.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+struct Counters {
+    alignas(64) std::atomic<uint64_t> bytesSent{0};
+    alignas(64) std::atomic<uint64_t> bytesTotal{0};
+    std::atomic<uint64_t> filesDone{0};
+    std::atomic<uint64_t> filesFailed{0};
+    std::atomic<uint64_t> filesTotal{0};
+    std::atomic<uint64_t> activeTransfers{0};
+};
+
+Counters counters;
+
+class RenderLoop {
+public:
+    void start(Progress::Renderer callback, int framesPerSecond) {
+        stop();
+        renderer = std::move(callback);
+        frame = std::chrono::microseconds(1000000 / std::max(framesPerSecond, 1));
+        stopping = false;
+        worker = std::thread(&RenderLoop::run, this);
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            if (!worker.joinable()) return;
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+    }
+
+    ~RenderLoop() { stop(); }
+
+private:
+    void run() {
+        auto started = std::chrono::steady_clock::now();
+        auto lastFrame = started;
+        uint64_t lastSent = counters.bytesSent.load(std::memory_order_relaxed);
+        double rate = 0.0;
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        for (;;) {
+            bool final = wake.wait_for(lock, frame, [this] { return stopping; });
+            auto now = std::chrono::steady_clock::now();
+            ProgressSnapshot current = Progress::snapshot();
+            double dt = std::chrono::duration<double>(now - lastFrame).count();
+            if (dt > 0) {
+                double instant = static_cast<double>(current.bytesSent >= lastSent ? current.bytesSent - lastSent : 0) / dt;
+                rate = rate == 0.0 ? instant : rate * 0.7 + instant * 0.3;
+            }
+            lastFrame = now;
+            lastSent = current.bytesSent;
+            current.bytesPerSecond = rate;
+            current.elapsedSeconds = std::chrono::duration<double>(now - started).count();
+            uint64_t remaining = current.bytesTotal > current.bytesSent ? current.bytesTotal - current.bytesSent : 0;
+            current.etaSeconds = rate > 0 ? static_cast<double>(remaining) / rate : 0.0;
+            if (current.bytesTotal > 0 || current.filesTotal > 0) renderer(current, final);
+            if (final) return;
+        }
+    }
+
+    Progress::Renderer renderer;
+    std::chrono::microseconds frame{100000};
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+};
+
+RenderLoop& renderLoop() {
+    static RenderLoop instance;
+    return instance;
+}
+
+}
+
+Progress::Transfer::Transfer(uint64_t totalBytes) : total(totalBytes) {
+    counters.bytesTotal.fetch_add(total, std::memory_order_relaxed);
+    counters.activeTransfers.fetch_add(1, std::memory_order_relaxed);
+}
+
+Progress::Transfer::~Transfer() {
+    counters.activeTransfers.fetch_sub(1, std::memory_order_relaxed);
+    if (completed) return;
+    counters.bytesSent.fetch_sub(reported, std::memory_order_relaxed);
+    counters.bytesTotal.fetch_sub(total, std::memory_order_relaxed);
+}
+
+void Progress::Transfer::update(uint64_t sentBytes) {
+    sentBytes = std::min(sentBytes, total);
+    if (sentBytes <= reported) return;
+    counters.bytesSent.fetch_add(sentBytes - reported, std::memory_order_relaxed);
+    reported = sentBytes;
+}
+
+void Progress::Transfer::complete() {
+    if (completed) return;
+    update(total);
+    completed = true;
+    counters.filesDone.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Progress::expectFiles(uint64_t count) {
+    counters.filesTotal.fetch_add(count, std::memory_order_relaxed);
+}
+
+void Progress::fileFailed() {
+    counters.filesFailed.fetch_add(1, std::memory_order_relaxed);
+}
+
+ProgressSnapshot Progress::snapshot() {
+    ProgressSnapshot current;
+    current.bytesSent = counters.bytesSent.load(std::memory_order_relaxed);
+    current.bytesTotal = counters.bytesTotal.load(std::memory_order_relaxed);
+    current.filesDone = counters.filesDone.load(std::memory_order_relaxed);
+    current.filesFailed = counters.filesFailed.load(std::memory_order_relaxed);
+    current.filesTotal = counters.filesTotal.load(std::memory_order_relaxed);
+    current.activeTransfers = counters.activeTransfers.load(std::memory_order_relaxed);
+    return current;
+}
+
+void Progress::start(Renderer renderer, int framesPerSecond) {
+    renderLoop().start(std::move(renderer), framesPerSecond);
+}
+
+void Progress::stop() {
+    renderLoop().stop();
+}
@@ -0,0 +1,48 @@
+#ifndef PROGRESS_HPP
+#define PROGRESS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+struct ProgressSnapshot {
+    uint64_t bytesSent = 0;
+    uint64_t bytesTotal = 0;
+    uint64_t filesDone = 0;
+    uint64_t filesFailed = 0;
+    uint64_t filesTotal = 0;
+    uint64_t activeTransfers = 0;
+    double bytesPerSecond = 0.0;
+    double etaSeconds = 0.0;
+    double elapsedSeconds = 0.0;
+};
+
+class Progress {
+public:
+    static constexpr int DefaultFramesPerSecond = 10;
+    using Renderer = std::function<void(const ProgressSnapshot&, bool final)>;
+
+    class Transfer {
+    public:
+        explicit Transfer(uint64_t totalBytes);
+        Transfer(const Transfer&) = delete;
+        Transfer& operator=(const Transfer&) = delete;
+        ~Transfer();
+
+        void update(uint64_t sentBytes);
+        void complete();
+
+    private:
+        uint64_t total;
+        uint64_t reported = 0;
+        bool completed = false;
+    };
+
+    static void expectFiles(uint64_t count);
+    static void fileFailed();
+    static ProgressSnapshot snapshot();
+    static void start(Renderer renderer, int framesPerSecond = DefaultFramesPerSecond);
+    static void stop();
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "request_recorder.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+std::mutex writerMutex;
+std::FILE* output = nullptr;
+std::string pending;
+std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+std::atomic<uint16_t> threadIds{0};
+
+template<typename T>
+void put(std::string& out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) out += static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xff);
+}
+
+template<typename T>
+T get(const unsigned char*& in) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    in += sizeof(T);
+    return static_cast<T>(value);
+}
+
+uint16_t threadId() {
+    thread_local uint16_t id = threadIds.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void writePending() {
+    if (output && !pending.empty()) std::fwrite(pending.data(), 1, pending.size(), output);
+    pending.clear();
+}
+
+}
+
+std::atomic<bool> RequestRecorder::active{false};
+
+std::expected<void, std::string> RequestRecorder::open(const std::string& path, const std::vector<std::string_view>& endpointNames) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return std::unexpected("Could not open request trace " + path + ": " + std::strerror(errno));
+    if (output) {
+        writePending();
+        std::fclose(output);
+    }
+    output = file;
+    epoch = std::chrono::steady_clock::now();
+
+    pending.reserve(FlushThreshold * 2);
+    pending.append(Magic);
+    put(pending, Version);
+    put(pending, static_cast<uint16_t>(RecordSize));
+    put(pending, static_cast<uint8_t>(endpointNames.size()));
+    for (std::string_view name : endpointNames) {
+        put(pending, static_cast<uint8_t>(name.size()));
+        pending.append(name.substr(0, 255));
+    }
+    if (!active.exchange(true, std::memory_order_acq_rel)) std::atexit(&RequestRecorder::close);
+    return {};
+}
+
+uint64_t RequestRecorder::nowUs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void RequestRecorder::record(const RecordedRequest& request) {
+    uint16_t thread = threadId();
+    std::lock_guard<std::mutex> lock(writerMutex);
+    if (!output) return;
+    put(pending, request.startUs);
+    put(pending, request.bytesUp);
+    put(pending, request.bytesDown);
+    put(pending, request.nameLookupUs);
+    put(pending, request.connectUs);
+    put(pending, request.appConnectUs);
+    put(pending, request.preTransferUs);
+    put(pending, request.startTransferUs);
+    put(pending, request.totalUs);
+    put(pending, request.httpStatus);
+    put(pending, request.curlResult);
+    put(pending, request.endpoint);
+    put(pending, static_cast<uint8_t>(request.connectionReused));
+    put(pending, thread);
+    if (pending.size() >= FlushThreshold) writePending();
+}
+
+void RequestRecorder::close() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    writePending();
+    if (output) std::fclose(output);
+    output = nullptr;
+    active.store(false, std::memory_order_release);
+}
+
+std::expected<RecordedTrace, std::string> RequestRecorder::read(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return std::unexpected("Could not open request trace " + path + ": " + std::strerror(errno));
+    std::string data;
+    char buffer[64 * 1024];
+    for (size_t count; (count = std::fread(buffer, 1, sizeof(buffer), file)) > 0;) data.append(buffer, count);
+    std::fclose(file);
+
+    auto truncated = [&path] { return std::unexpected("Request trace " + path + " is truncated"); };
+    if (data.size() < Magic.size() + 5 || std::string_view(data).substr(0, Magic.size()) != Magic) return std::unexpected(path + " is not a request trace");
+    const auto* cursor = reinterpret_cast<const unsigned char*>(data.data()) + Magic.size();
+    const auto* end = reinterpret_cast<const unsigned char*>(data.data()) + data.size();
+    auto version = get<uint16_t>(cursor);
+    auto recordSize = get<uint16_t>(cursor);
+    if (version != Version || recordSize < RecordSize) return std::unexpected(std::string("Unsupported request trace version in ") + path);
+
+    RecordedTrace trace;
+    auto endpointCount = get<uint8_t>(cursor);
+    for (uint8_t i = 0; i < endpointCount; ++i) {
+        if (cursor >= end) return truncated();
+        auto length = get<uint8_t>(cursor);
+        if (end - cursor < length) return truncated();
+        trace.endpoints.emplace_back(reinterpret_cast<const char*>(cursor), length);
+        cursor += length;
+    }
+
+    trace.requests.reserve(static_cast<size_t>(end - cursor) / recordSize);
+    while (static_cast<size_t>(end - cursor) >= recordSize) {
+        const unsigned char* next = cursor + recordSize;
+        RecordedRequest request;
+        request.startUs = get<uint64_t>(cursor);
+        request.bytesUp = get<uint64_t>(cursor);
+        request.bytesDown = get<uint64_t>(cursor);
+        request.nameLookupUs = get<uint32_t>(cursor);
+        request.connectUs = get<uint32_t>(cursor);
+        request.appConnectUs = get<uint32_t>(cursor);
+        request.preTransferUs = get<uint32_t>(cursor);
+        request.startTransferUs = get<uint32_t>(cursor);
+        request.totalUs = get<uint32_t>(cursor);
+        request.httpStatus = get<uint16_t>(cursor);
+        request.curlResult = get<uint16_t>(cursor);
+        request.endpoint = get<uint8_t>(cursor);
+        request.connectionReused = get<uint8_t>(cursor) != 0;
+        request.thread = get<uint16_t>(cursor);
+        trace.requests.push_back(request);
+        cursor = next;
+    }
+    return trace;
+}
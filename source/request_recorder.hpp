@@ -0,0 +1,52 @@
+#ifndef REQUEST_RECORDER_HPP
+#define REQUEST_RECORDER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct RecordedRequest {
+    uint64_t startUs = 0;
+    uint64_t bytesUp = 0;
+    uint64_t bytesDown = 0;
+    uint32_t nameLookupUs = 0;
+    uint32_t connectUs = 0;
+    uint32_t appConnectUs = 0;
+    uint32_t preTransferUs = 0;
+    uint32_t startTransferUs = 0;
+    uint32_t totalUs = 0;
+    uint16_t httpStatus = 0;
+    uint16_t curlResult = 0;
+    uint8_t endpoint = 0;
+    bool connectionReused = false;
+    uint16_t thread = 0;
+};
+
+struct RecordedTrace {
+    std::vector<std::string> endpoints;
+    std::vector<RecordedRequest> requests;
+};
+
+class RequestRecorder {
+public:
+    static constexpr std::string_view Magic = "PPRQ";
+    static constexpr uint16_t Version = 1;
+    static constexpr size_t RecordSize = 56;
+    static constexpr size_t FlushThreshold = 64 * 1024;
+
+    static std::expected<void, std::string> open(const std::string& path, const std::vector<std::string_view>& endpointNames);
+    static bool enabled() { return active.load(std::memory_order_acquire); }
+    static uint64_t nowUs();
+    static void record(const RecordedRequest& request);
+    static void close();
+    static std::expected<RecordedTrace, std::string> read(const std::string& path);
+
+private:
+    static std::atomic<bool> active;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "sha256.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <iterator>
+
+namespace {
+
+constexpr std::array<uint32_t, 64> RoundConstants{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74,
+    0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d,
+    0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e,
+    0x92722c85, 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+}
+
+Sha256& Sha256::update(std::string_view data) {
+    length += data.size();
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    size_t remaining = data.size();
+    if (buffered > 0) {
+        size_t take = std::min(remaining, buffer.size() - buffered);
+        std::memcpy(buffer.data() + buffered, bytes, take);
+        buffered += take;
+        bytes += take;
+        remaining -= take;
+        if (buffered < buffer.size()) return *this;
+        compress(buffer.data());
+        buffered = 0;
+    }
+    for (; remaining >= buffer.size(); bytes += buffer.size(), remaining -= buffer.size()) compress(bytes);
+    std::memcpy(buffer.data(), bytes, remaining);
+    buffered = remaining;
+    return *this;
+}
+
+Sha256::Digest Sha256::finish() {
+    uint64_t bits = length * 8;
+    uint8_t padding[72] = {0x80};
+    size_t padLength = (buffered < 56 ? 56 : 120) - buffered;
+    for (size_t i = 0; i < 8; ++i) padding[padLength + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+    update(std::string_view(reinterpret_cast<const char*>(padding), padLength + 8));
+
+    Digest digest;
+    for (size_t i = 0; i < state.size(); ++i) {
+        for (size_t j = 0; j < 4; ++j) digest[i * 4 + j] = static_cast<uint8_t>(state[i] >> (24 - 8 * j));
+    }
+    return digest;
+}
+
+std::string Sha256::hex(std::string_view data) {
+    return toHex(Sha256().update(data).finish());
+}
+
+Sha256::Digest Sha256::hmac(std::string_view key, std::string_view message) {
+    std::array<char, 64> block{};
+    if (key.size() > block.size()) {
+        Digest hashed = Sha256().update(key).finish();
+        std::memcpy(block.data(), hashed.data(), hashed.size());
+    } else {
+        std::memcpy(block.data(), key.data(), key.size());
+    }
+    std::array<char, 64> innerPad;
+    std::array<char, 64> outerPad;
+    for (size_t i = 0; i < block.size(); ++i) {
+        innerPad[i] = static_cast<char>(block[i] ^ 0x36);
+        outerPad[i] = static_cast<char>(block[i] ^ 0x5c);
+    }
+    Digest inner = Sha256().update(std::string_view(innerPad.data(), innerPad.size())).update(message).finish();
+    return Sha256().update(std::string_view(outerPad.data(), outerPad.size())).update(std::string_view(reinterpret_cast<const char*>(inner.data()), inner.size())).finish();
+}
+
+std::string Sha256::toHex(const Digest& digest) {
+    std::string result;
+    result.reserve(digest.size() * 2);
+    for (uint8_t byte : digest) std::format_to(std::back_inserter(result), "{:02x}", byte);
+    return result;
+}
+
+void Sha256::compress(const uint8_t* block) {
+    std::array<uint32_t, 64> w;
+    for (size_t i = 0; i < 16; ++i) {
+        w[i] = static_cast<uint32_t>(block[i * 4]) << 24 | static_cast<uint32_t>(block[i * 4 + 1]) << 16 | static_cast<uint32_t>(block[i * 4 + 2]) << 8 | block[i * 4 + 3];
+    }
+    for (size_t i = 16; i < 64; ++i) {
+        uint32_t s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    auto [a, b, c, d, e, f, g, h] = state;
+    for (size_t i = 0; i < 64; ++i) {
+        uint32_t t1 = h + (std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25)) + ((e & f) ^ (~e & g)) + RoundConstants[i] + w[i];
+        uint32_t t2 = (std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
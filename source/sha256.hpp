@@ -0,0 +1,30 @@
+#ifndef SHA256_HPP
+#define SHA256_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class Sha256 {
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    Sha256& update(std::string_view data);
+    Digest finish();
+
+    static std::string hex(std::string_view data);
+    static Digest hmac(std::string_view key, std::string_view message);
+    static std::string toHex(const Digest& digest);
+
+private:
+    void compress(const uint8_t* block);
+
+    std::array<uint32_t, 8> state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    std::array<uint8_t, 64> buffer{};
+    size_t buffered = 0;
+    uint64_t length = 0;
+};
+
+#endif
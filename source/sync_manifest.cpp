@@ -0,0 +1,252 @@
+#include "sync_manifest.hpp"
+#include "logger.hpp"
+#include "private_file.hpp"
+#include "sha256.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint8_t RecordStore = '+';
+constexpr uint8_t RecordRemove = '-';
+constexpr size_t IdentifyChunk = 256;
+
+template<typename T>
+void put(std::string& out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) out += static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xff);
+}
+
+template<typename T>
+T get(const unsigned char*& in) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    in += sizeof(T);
+    return static_cast<T>(value);
+}
+
+void putStore(std::string& out, std::string_view path, const ManifestEntry& entry) {
+    put(out, RecordStore);
+    put(out, static_cast<uint32_t>(path.size()));
+    out.append(path);
+    put(out, entry.identity.device);
+    put(out, entry.identity.inode);
+    put(out, entry.identity.size);
+    put(out, entry.identity.mtimeNs);
+    put(out, static_cast<uint16_t>(entry.cid.size()));
+    out.append(entry.cid);
+}
+
+}
+
+SyncManifest::SyncManifest(std::filesystem::path path, std::string scope) : path(std::move(path)), scopeDigest(std::move(scope)) {}
+
+SyncManifest::~SyncManifest() {
+    if (log) {
+        if (needsCompaction()) {
+            if (auto compacted = compact(); !compacted) Logger::warn("{}", compacted.error());
+        }
+        if (auto flushed = flush(); !flushed) Logger::warn("{}", flushed.error());
+        if (log) std::fclose(log);
+    }
+#ifndef _WIN32
+    if (lockFd >= 0) ::close(lockFd);
+#endif
+}
+
+std::string SyncManifest::scope(std::string_view account, std::string_view metadata) {
+    Sha256 hash;
+    hash.update("pinatapipe sync manifest").update(std::string_view("\0", 1)).update(account).update(std::string_view("\0", 1)).update(metadata);
+    return Sha256::toHex(hash.finish());
+}
+
+std::filesystem::path SyncManifest::defaultPath(std::string_view scope) {
+    return userCacheDirectory() / ("manifest-" + std::string(scope.substr(0, 16)));
+}
+
+std::string SyncManifest::header() const {
+    std::string out(Magic);
+    put(out, Version);
+    put(out, static_cast<uint8_t>(scopeDigest.size()));
+    out.append(scopeDigest);
+    return out;
+}
+
+std::expected<void, std::string> SyncManifest::open() {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+#ifndef _WIN32
+    std::string lockPath = path.string() + ".lock";
+    lockFd = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (lockFd < 0) return std::unexpected("Could not open " + lockPath + ": " + std::strerror(errno));
+    if (::flock(lockFd, LOCK_EX | LOCK_NB) != 0) return std::unexpected("Sync manifest " + path.string() + " is in use by another process");
+#endif
+    auto clean = load();
+    if (!clean) return std::unexpected(clean.error());
+    if (!*clean || needsCompaction()) return compact();
+    bool empty = std::filesystem::file_size(path, ec) == 0 || ec;
+    log = std::fopen(path.c_str(), "ab");
+    if (!log) return std::unexpected("Could not open sync manifest " + path.string() + ": " + std::strerror(errno));
+    if (empty) pending = header();
+    return {};
+}
+
+std::expected<bool, std::string> SyncManifest::load() {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return true;
+    std::string data;
+    char buffer[256 * 1024];
+    for (size_t count; (count = std::fread(buffer, 1, sizeof(buffer), file)) > 0;) data.append(buffer, count);
+    std::fclose(file);
+    if (data.empty()) return true;
+
+    std::string version(Magic);
+    put(version, Version);
+    if (!data.starts_with(version)) return std::unexpected(path.string() + " is not a sync manifest or has an unsupported version");
+    std::string expected = header();
+    if (!data.starts_with(expected)) return std::unexpected("Sync manifest " + path.string() + " was written for a different API endpoint, account or metadata");
+    const auto* cursor = reinterpret_cast<const unsigned char*>(data.data()) + expected.size();
+    const auto* end = reinterpret_cast<const unsigned char*>(data.data()) + data.size();
+    entries.reserve(data.size() / 128);
+    while (end - cursor >= 5) {
+        const unsigned char* start = cursor;
+        auto kind = get<uint8_t>(cursor);
+        auto pathLength = get<uint32_t>(cursor);
+        if (static_cast<size_t>(end - cursor) < pathLength) return false;
+        std::string entryPath(reinterpret_cast<const char*>(cursor), pathLength);
+        cursor += pathLength;
+        ++records;
+        if (kind == RecordRemove) {
+            entries.erase(entryPath);
+            continue;
+        }
+        if (kind != RecordStore || end - cursor < 34) {
+            cursor = start;
+            break;
+        }
+        ManifestEntry entry;
+        entry.identity.device = get<uint64_t>(cursor);
+        entry.identity.inode = get<uint64_t>(cursor);
+        entry.identity.size = get<uint64_t>(cursor);
+        entry.identity.mtimeNs = get<int64_t>(cursor);
+        auto cidLength = get<uint16_t>(cursor);
+        if (end - cursor < cidLength) return false;
+        entry.cid.assign(reinterpret_cast<const char*>(cursor), cidLength);
+        cursor += cidLength;
+        entries.insert_or_assign(std::move(entryPath), std::move(entry));
+    }
+    return cursor == end;
+}
+
+const ManifestEntry* SyncManifest::find(const std::string& path) const {
+    auto entry = entries.find(path);
+    return entry == entries.end() ? nullptr : &entry->second;
+}
+
+std::optional<std::string> SyncManifest::unchangedCid(const std::string& path, const FileIdentity& identity) const {
+    const ManifestEntry* entry = find(path);
+    if (!entry || entry->identity != identity) return std::nullopt;
+    return entry->cid;
+}
+
+void SyncManifest::record(const std::string& path, const FileIdentity& identity, std::string cid) {
+    auto entry = entries.insert_or_assign(path, ManifestEntry{identity, std::move(cid)}).first;
+    putStore(pending, entry->first, entry->second);
+    ++records;
+    if (pending.size() >= FlushThreshold) {
+        if (auto flushed = flush(); !flushed) Logger::warn("{}", flushed.error());
+    }
+}
+
+bool SyncManifest::remove(const std::string& path) {
+    auto entry = entries.find(path);
+    if (entry == entries.end()) return false;
+    appendRemoval(entry->first);
+    entries.erase(entry);
+    return true;
+}
+
+void SyncManifest::appendRemoval(std::string_view path) {
+    put(pending, RecordRemove);
+    put(pending, static_cast<uint32_t>(path.size()));
+    pending.append(path);
+    ++records;
+}
+
+std::expected<void, std::string> SyncManifest::flush() {
+    if (!log || pending.empty()) return {};
+    bool written = std::fwrite(pending.data(), 1, pending.size(), log) == pending.size() && std::fflush(log) == 0;
+    pending.clear();
+    if (!written) return std::unexpected("Could not append to sync manifest " + path.string() + ": " + std::strerror(errno));
+    return {};
+}
+
+std::expected<void, std::string> SyncManifest::compact() {
+    std::string contents = header();
+    contents.reserve(contents.size() + entries.size() * 128);
+    for (const auto& [entryPath, entry] : entries) putStore(contents, entryPath, entry);
+    if (log) {
+        std::fclose(log);
+        log = nullptr;
+    }
+    pending.clear();
+    auto written = writePrivateFile(path, contents);
+    if (!written) return std::unexpected("Could not compact sync manifest: " + written.error());
+    Logger::debug("Compacted sync manifest {} from {} to {} records", path.string(), records, entries.size());
+    records = entries.size();
+    log = std::fopen(path.c_str(), "ab");
+    if (!log) return std::unexpected("Could not open sync manifest " + path.string() + ": " + std::strerror(errno));
+    return {};
+}
+
+std::optional<FileIdentity> SyncManifest::identify(const std::string& path) {
+#ifndef _WIN32
+    struct stat info;
+    if (::stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) return std::nullopt;
+    FileIdentity identity;
+    identity.device = static_cast<uint64_t>(info.st_dev);
+    identity.inode = static_cast<uint64_t>(info.st_ino);
+    identity.size = static_cast<uint64_t>(info.st_size);
+#ifdef __APPLE__
+    identity.mtimeNs = static_cast<int64_t>(info.st_mtimespec.tv_sec) * 1'000'000'000 + info.st_mtimespec.tv_nsec;
+#else
+    identity.mtimeNs = static_cast<int64_t>(info.st_mtim.tv_sec) * 1'000'000'000 + info.st_mtim.tv_nsec;
+#endif
+    return identity;
+#else
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) return std::nullopt;
+    FileIdentity identity;
+    identity.size = std::filesystem::file_size(path, ec);
+    identity.mtimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::filesystem::last_write_time(path, ec).time_since_epoch()).count();
+    return identity;
+#endif
+}
+
+std::vector<std::optional<FileIdentity>> SyncManifest::identifyAll(const std::vector<std::string>& paths, size_t threads) {
+    std::vector<std::optional<FileIdentity>> identities(paths.size());
+    if (threads == 0) threads = std::clamp<size_t>(std::thread::hardware_concurrency() * 2, 2, 32);
+    threads = std::min(threads, (paths.size() + IdentifyChunk - 1) / IdentifyChunk);
+    std::atomic<size_t> next{0};
+    auto sweep = [&] {
+        for (size_t begin; (begin = next.fetch_add(IdentifyChunk, std::memory_order_relaxed)) < paths.size();) {
+            size_t end = std::min(begin + IdentifyChunk, paths.size());
+            for (size_t i = begin; i < end; ++i) identities[i] = identify(paths[i]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i) workers.emplace_back(sweep);
+    sweep();
+    for (auto& worker : workers) worker.join();
+    return identities;
+}
@@ -0,0 +1,85 @@
+#ifndef SYNC_MANIFEST_HPP
+#define SYNC_MANIFEST_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct FileIdentity {
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+
+    bool operator==(const FileIdentity&) const = default;
+};
+
+struct ManifestEntry {
+    FileIdentity identity;
+    std::string cid;
+};
+
+class SyncManifest {
+public:
+    static constexpr std::string_view Magic = "PPSM";
+    static constexpr uint16_t Version = 2;
+    static constexpr size_t FlushThreshold = 1024 * 1024;
+    static constexpr size_t CompactionSlack = 4096;
+
+    SyncManifest(std::filesystem::path path, std::string scope);
+    SyncManifest(const SyncManifest&) = delete;
+    SyncManifest& operator=(const SyncManifest&) = delete;
+    ~SyncManifest();
+
+    std::expected<void, std::string> open();
+    const ManifestEntry* find(const std::string& path) const;
+    std::optional<std::string> unchangedCid(const std::string& path, const FileIdentity& identity) const;
+    void record(const std::string& path, const FileIdentity& identity, std::string cid);
+    bool remove(const std::string& path);
+    std::expected<void, std::string> flush();
+    std::expected<void, std::string> compact();
+    size_t size() const { return entries.size(); }
+    const std::filesystem::path& location() const { return path; }
+
+    template<typename Predicate>
+    size_t removeIf(Predicate predicate) {
+        size_t removed = 0;
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (!predicate(it->first)) {
+                ++it;
+                continue;
+            }
+            appendRemoval(it->first);
+            it = entries.erase(it);
+            ++removed;
+        }
+        return removed;
+    }
+
+    static std::optional<FileIdentity> identify(const std::string& path);
+    static std::vector<std::optional<FileIdentity>> identifyAll(const std::vector<std::string>& paths, size_t threads = 0);
+    static std::string scope(std::string_view account, std::string_view metadata);
+    static std::filesystem::path defaultPath(std::string_view scope);
+
+private:
+    std::expected<bool, std::string> load();
+    std::string header() const;
+    void appendRemoval(std::string_view path);
+    bool needsCompaction() const { return records > entries.size() * 2 + CompactionSlack; }
+
+    std::filesystem::path path;
+    std::string scopeDigest;
+    std::unordered_map<std::string, ManifestEntry> entries;
+    std::FILE* log = nullptr;
+    int lockFd = -1;
+    std::string pending;
+    size_t records = 0;
+};
+
+#endif
@@ -0,0 +1,195 @@
+#include "trace.hpp"
+#include "event_log.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t FlushEvents = 1024;
+constexpr int64_t FlushIntervalUs = 1'000'000;
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    std::string detail;
+    int64_t startUs;
+    int64_t durationUs;
+};
+
+struct ThreadBuffer {
+    uint64_t threadId = 0;
+    bool named = false;
+    int64_t lastFlushUs = 0;
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+};
+
+std::mutex registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+std::FILE* output = nullptr;
+std::string outputPath;
+bool firstRecord = true;
+bool writeFailed = false;
+bool exitHandlerRegistered = false;
+uint64_t nextThreadId = 0;
+const auto epoch = std::chrono::steady_clock::now();
+
+long processId() {
+#ifdef _WIN32
+    return _getpid();
+#else
+    return static_cast<long>(::getpid());
+#endif
+}
+
+void appendRecord(std::string& out) {
+    if (!firstRecord) out += ",\n";
+    firstRecord = false;
+}
+
+void writeEvents(ThreadBuffer& buffer, const std::vector<TraceEvent>& events) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (!output || (events.empty() && buffer.named)) return;
+    std::string out;
+    auto it = std::back_inserter(out);
+    long pid = processId();
+    if (!buffer.named) {
+        appendRecord(out);
+        std::format_to(it, "{{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":{},\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}", pid, buffer.threadId,
+                       buffer.threadId == 1 ? "main" : std::format("worker-{}", buffer.threadId));
+        buffer.named = true;
+    }
+    for (const auto& event : events) {
+        appendRecord(out);
+        std::format_to(it, "{{\"ph\":\"X\",\"pid\":{},\"tid\":{},\"ts\":{},\"dur\":{},\"name\":", pid, buffer.threadId, event.startUs, event.durationUs);
+        EventLog::appendJsonString(out, event.name);
+        out += ",\"cat\":";
+        EventLog::appendJsonString(out, event.category);
+        if (!event.detail.empty()) {
+            out += ",\"args\":{\"detail\":";
+            EventLog::appendJsonString(out, event.detail);
+            out += '}';
+        }
+        out += '}';
+    }
+    if (std::fwrite(out.data(), 1, out.size(), output) != out.size()) writeFailed = true;
+}
+
+void flushBuffer(ThreadBuffer& buffer) {
+    std::vector<TraceEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        events.swap(buffer.events);
+        buffer.events.reserve(FlushEvents);
+        buffer.lastFlushUs = Trace::nowUs();
+    }
+    writeEvents(buffer, events);
+}
+
+struct LocalBuffer {
+    std::shared_ptr<ThreadBuffer> buffer;
+
+    LocalBuffer() : buffer(std::make_shared<ThreadBuffer>()) {
+        buffer->events.reserve(FlushEvents);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->threadId = ++nextThreadId;
+        buffers.push_back(buffer);
+    }
+
+    ~LocalBuffer() {
+        flushBuffer(*buffer);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::erase(buffers, buffer);
+    }
+};
+
+ThreadBuffer& localBuffer() {
+    thread_local LocalBuffer local;
+    return *local.buffer;
+}
+
+}
+
+std::atomic<bool> Trace::active{false};
+
+Trace::Span::Span(const char* name, const char* category, std::string_view detail) : name(name), category(category) {
+    if (!enabled()) return;
+    this->detail = detail;
+    startUs = nowUs();
+}
+
+Trace::Span::~Span() {
+    if (startUs >= 0 && enabled()) complete(name, category, startUs, nowUs() - startUs, detail);
+}
+
+int64_t Trace::nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Trace::complete(const char* name, const char* category, int64_t startUs, int64_t durationUs, std::string_view detail) {
+    if (!enabled()) return;
+    ThreadBuffer& buffer = localBuffer();
+    bool flush;
+    {
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.events.push_back({name, category, std::string(detail), startUs, durationUs});
+        flush = buffer.events.size() >= FlushEvents || startUs + durationUs - buffer.lastFlushUs >= FlushIntervalUs;
+    }
+    if (flush) flushBuffer(buffer);
+}
+
+std::expected<void, std::string> Trace::open(const std::string& path) {
+    (void)close();
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return std::unexpected("Could not open trace file " + path + ": " + std::strerror(errno));
+    localBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (!exitHandlerRegistered) std::atexit([] { (void)Trace::close(); });
+    exitHandlerRegistered = true;
+    output = file;
+    outputPath = path;
+    firstRecord = true;
+    writeFailed = false;
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->named = false;
+        buffer->events.clear();
+        buffer->lastFlushUs = nowUs();
+    }
+    static constexpr std::string_view Header = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    if (std::fwrite(Header.data(), 1, Header.size(), output) != Header.size()) writeFailed = true;
+    active.store(true, std::memory_order_release);
+    return {};
+}
+
+std::expected<void, std::string> Trace::close() {
+    if (!active.exchange(false, std::memory_order_acq_rel)) return {};
+    std::vector<std::shared_ptr<ThreadBuffer>> registered;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registered = buffers;
+    }
+    for (const auto& buffer : registered) flushBuffer(*buffer);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    static constexpr std::string_view Footer = "\n]}\n";
+    bool ok = !writeFailed && std::fwrite(Footer.data(), 1, Footer.size(), output) == Footer.size();
+    ok = std::fclose(output) == 0 && ok;
+    output = nullptr;
+    if (!ok) return std::unexpected("Could not write trace file " + outputPath + ": " + std::strerror(errno));
+    return {};
+}
@@ -0,0 +1,36 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <string_view>
+
+class Trace {
+public:
+    class Span {
+    public:
+        Span(const char* name, const char* category, std::string_view detail = {});
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+        ~Span();
+
+    private:
+        const char* name;
+        const char* category;
+        std::string detail;
+        int64_t startUs = -1;
+    };
+
+    static std::expected<void, std::string> open(const std::string& path);
+    static bool enabled() { return active.load(std::memory_order_acquire); }
+    static int64_t nowUs();
+    static void complete(const char* name, const char* category, int64_t startUs, int64_t durationUs, std::string_view detail = {});
+    static std::expected<void, std::string> close();
+
+private:
+    static std::atomic<bool> active;
+};
+
+#endif
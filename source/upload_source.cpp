@@ -0,0 +1,211 @@
+#include "upload_source.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::expected<MappedUploadSource, std::string> MappedUploadSource::open(const std::string& path) {
+#ifdef _WIN32
+    return std::unexpected("Memory-mapped uploads are not supported on this platform: " + path);
+#else
+    MappedUploadSource source;
+    source.fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (source.fd < 0) return std::unexpected("Could not open " + path + ": " + std::strerror(errno));
+
+    struct stat info {};
+    if (::fstat(source.fd, &info) != 0) return std::unexpected("Could not stat " + path + ": " + std::strerror(errno));
+    source.length = static_cast<size_t>(info.st_size);
+    if (source.length == 0) return source;
+
+    void* mapping = ::mmap(nullptr, source.length, PROT_READ, MAP_SHARED, source.fd, 0);
+    if (mapping == MAP_FAILED) return std::unexpected("Could not map " + path + ": " + std::strerror(errno));
+    source.data = static_cast<const char*>(mapping);
+    ::madvise(mapping, source.length, MADV_SEQUENTIAL);
+    return source;
+#endif
+}
+
+MappedUploadSource::MappedUploadSource(MappedUploadSource&& other) noexcept
+    : fd(std::exchange(other.fd, -1)), data(std::exchange(other.data, nullptr)), length(std::exchange(other.length, 0)), position(std::exchange(other.position, 0)) {}
+
+MappedUploadSource& MappedUploadSource::operator=(MappedUploadSource&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd = std::exchange(other.fd, -1);
+        data = std::exchange(other.data, nullptr);
+        length = std::exchange(other.length, 0);
+        position = std::exchange(other.position, 0);
+    }
+    return *this;
+}
+
+MappedUploadSource::~MappedUploadSource() {
+    close();
+}
+
+void MappedUploadSource::close() {
+#ifndef _WIN32
+    if (data) ::munmap(const_cast<char*>(data), length);
+    if (fd >= 0) ::close(fd);
+#endif
+    data = nullptr;
+    fd = -1;
+}
+
+void MappedUploadSource::attach(curl_mimepart* part) {
+    position = 0;
+    curl_mime_data_cb(part, size(), readCallback, seekCallback, nullptr, this);
+}
+
+size_t MappedUploadSource::readCallback(char* buffer, size_t size, size_t nitems, void* arg) {
+    auto* source = static_cast<MappedUploadSource*>(arg);
+    size_t count = std::min(size * nitems, source->length - source->position);
+    if (count == 0) return 0;
+    std::memcpy(buffer, source->data + source->position, count);
+    source->position += count;
+    return count;
+}
+
+int MappedUploadSource::seekCallback(void* arg, curl_off_t offset, int origin) {
+    auto* source = static_cast<MappedUploadSource*>(arg);
+    curl_off_t base = 0;
+    if (origin == SEEK_CUR) base = static_cast<curl_off_t>(source->position);
+    else if (origin == SEEK_END) base = source->size();
+    curl_off_t target = base + offset;
+    if (target < 0 || target > source->size()) return CURL_SEEKFUNC_FAIL;
+    source->position = static_cast<size_t>(target);
+    return CURL_SEEKFUNC_OK;
+}
+
+std::expected<BulkUploadSource, std::string> BulkUploadSource::open(const std::string& path, bool directIO) {
+#ifdef _WIN32
+    (void)directIO;
+    return std::unexpected("Bulk uploads are not supported on this platform: " + path);
+#else
+    BulkUploadSource source;
+#ifdef O_DIRECT
+    if (directIO) {
+        source.fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+        source.direct = source.fd >= 0;
+    }
+#else
+    (void)directIO;
+#endif
+    if (source.fd < 0) source.fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (source.fd < 0) return std::unexpected("Could not open " + path + ": " + std::strerror(errno));
+
+    struct stat info {};
+    if (::fstat(source.fd, &info) != 0) return std::unexpected("Could not stat " + path + ": " + std::strerror(errno));
+    source.length = static_cast<size_t>(info.st_size);
+#ifdef POSIX_FADV_SEQUENTIAL
+    if (!source.direct) ::posix_fadvise(source.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    source.chunk = static_cast<char*>(::operator new(ChunkSize, std::align_val_t(Alignment)));
+    return source;
+#endif
+}
+
+BulkUploadSource::BulkUploadSource(BulkUploadSource&& other) noexcept
+    : fd(std::exchange(other.fd, -1)), direct(other.direct), chunk(std::exchange(other.chunk, nullptr)), length(std::exchange(other.length, 0)),
+      position(std::exchange(other.position, 0)), chunkStart(std::exchange(other.chunkStart, 0)), chunkEnd(std::exchange(other.chunkEnd, 0)),
+      droppedUpTo(std::exchange(other.droppedUpTo, 0)), accountedUpTo(std::exchange(other.accountedUpTo, 0)), bypassed(std::exchange(other.bypassed, 0)) {}
+
+BulkUploadSource& BulkUploadSource::operator=(BulkUploadSource&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd = std::exchange(other.fd, -1);
+        direct = other.direct;
+        chunk = std::exchange(other.chunk, nullptr);
+        length = std::exchange(other.length, 0);
+        position = std::exchange(other.position, 0);
+        chunkStart = std::exchange(other.chunkStart, 0);
+        chunkEnd = std::exchange(other.chunkEnd, 0);
+        droppedUpTo = std::exchange(other.droppedUpTo, 0);
+        accountedUpTo = std::exchange(other.accountedUpTo, 0);
+        bypassed = std::exchange(other.bypassed, 0);
+    }
+    return *this;
+}
+
+BulkUploadSource::~BulkUploadSource() {
+    close();
+}
+
+void BulkUploadSource::close() {
+#ifndef _WIN32
+    if (fd >= 0) {
+        releaseCache();
+        ::close(fd);
+    }
+#endif
+    if (chunk) ::operator delete(chunk, std::align_val_t(Alignment));
+    chunk = nullptr;
+    fd = -1;
+}
+
+void BulkUploadSource::attach(curl_mimepart* part) {
+    position = 0;
+    curl_mime_data_cb(part, size(), readCallback, seekCallback, nullptr, this);
+}
+
+bool BulkUploadSource::refill() {
+#ifdef _WIN32
+    return false;
+#else
+    size_t aligned = position & ~(Alignment - 1);
+    ssize_t count = ::pread(fd, chunk, ChunkSize, static_cast<off_t>(aligned));
+    if (count <= 0) return false;
+    chunkStart = aligned;
+    chunkEnd = aligned + static_cast<size_t>(count);
+    if (direct) account(chunkEnd);
+    dropBefore(chunkStart);
+    return chunkEnd > position;
+#endif
+}
+
+void BulkUploadSource::dropBefore(size_t offset) {
+    if (direct || offset <= droppedUpTo) return;
+#ifdef POSIX_FADV_DONTNEED
+    ::posix_fadvise(fd, static_cast<off_t>(droppedUpTo), static_cast<off_t>(offset - droppedUpTo), POSIX_FADV_DONTNEED);
+    account(offset);
+#endif
+    droppedUpTo = offset;
+}
+
+void BulkUploadSource::account(size_t offset) {
+    if (offset <= accountedUpTo) return;
+    bypassed += offset - accountedUpTo;
+    accountedUpTo = offset;
+}
+
+size_t BulkUploadSource::readCallback(char* buffer, size_t size, size_t nitems, void* arg) {
+    auto* source = static_cast<BulkUploadSource*>(arg);
+    if (source->position >= source->length) return 0;
+    if (source->position < source->chunkStart || source->position >= source->chunkEnd) {
+        if (!source->refill()) return CURL_READFUNC_ABORT;
+    }
+    size_t count = std::min(size * nitems, source->chunkEnd - source->position);
+    std::memcpy(buffer, source->chunk + (source->position - source->chunkStart), count);
+    source->position += count;
+    return count;
+}
+
+int BulkUploadSource::seekCallback(void* arg, curl_off_t offset, int origin) {
+    auto* source = static_cast<BulkUploadSource*>(arg);
+    curl_off_t base = 0;
+    if (origin == SEEK_CUR) base = static_cast<curl_off_t>(source->position);
+    else if (origin == SEEK_END) base = source->size();
+    curl_off_t target = base + offset;
+    if (target < 0 || target > source->size()) return CURL_SEEKFUNC_FAIL;
+    source->position = static_cast<size_t>(target);
+    source->droppedUpTo = std::min(source->droppedUpTo, source->position & ~(Alignment - 1));
+    return CURL_SEEKFUNC_OK;
+}
@@ -0,0 +1,76 @@
+#ifndef UPLOAD_SOURCE_HPP
+#define UPLOAD_SOURCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <string>
+#include <curl/curl.h>
+
+class MappedUploadSource {
+public:
+    static std::expected<MappedUploadSource, std::string> open(const std::string& path);
+
+    MappedUploadSource(MappedUploadSource&& other) noexcept;
+    MappedUploadSource& operator=(MappedUploadSource&& other) noexcept;
+    MappedUploadSource(const MappedUploadSource&) = delete;
+    MappedUploadSource& operator=(const MappedUploadSource&) = delete;
+    ~MappedUploadSource();
+
+    curl_off_t size() const { return static_cast<curl_off_t>(length); }
+    void attach(curl_mimepart* part);
+
+    static size_t readCallback(char* buffer, size_t size, size_t nitems, void* arg);
+    static int seekCallback(void* arg, curl_off_t offset, int origin);
+
+private:
+    MappedUploadSource() = default;
+    void close();
+
+    int fd = -1;
+    const char* data = nullptr;
+    size_t length = 0;
+    size_t position = 0;
+};
+
+class BulkUploadSource {
+public:
+    static constexpr size_t ChunkSize = 1024 * 1024;
+    static constexpr size_t Alignment = 4096;
+
+    static std::expected<BulkUploadSource, std::string> open(const std::string& path, bool directIO);
+
+    BulkUploadSource(BulkUploadSource&& other) noexcept;
+    BulkUploadSource& operator=(BulkUploadSource&& other) noexcept;
+    BulkUploadSource(const BulkUploadSource&) = delete;
+    BulkUploadSource& operator=(const BulkUploadSource&) = delete;
+    ~BulkUploadSource();
+
+    curl_off_t size() const { return static_cast<curl_off_t>(length); }
+    uint64_t bytesBypassed() const { return bypassed; }
+    void attach(curl_mimepart* part);
+    void releaseCache() { dropBefore(length); }
+
+    static size_t readCallback(char* buffer, size_t size, size_t nitems, void* arg);
+    static int seekCallback(void* arg, curl_off_t offset, int origin);
+
+private:
+    BulkUploadSource() = default;
+    bool refill();
+    void dropBefore(size_t offset);
+    void account(size_t offset);
+    void close();
+
+    int fd = -1;
+    bool direct = false;
+    char* chunk = nullptr;
+    size_t length = 0;
+    size_t position = 0;
+    size_t chunkStart = 0;
+    size_t chunkEnd = 0;
+    size_t droppedUpTo = 0;
+    size_t accountedUpTo = 0;
+    uint64_t bypassed = 0;
+};
+
+#endif
@@ -0,0 +1,231 @@
+#include "batch_journal.hpp"
+#include "latency_histogram.hpp"
+#include "sync_manifest.hpp"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class TempDirectory : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::random_device random;
+        directory = fs::temp_directory_path() / ("pinatapipe-test-" + std::to_string(random()));
+        fs::create_directories(directory);
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        fs::remove_all(directory, ec);
+    }
+
+    std::string file(const std::string& name) const { return (directory / name).string(); }
+
+    fs::path directory;
+};
+
+std::string readAll(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(input), {});
+}
+
+void writeAll(const std::string& path, std::string_view contents, std::ios::openmode mode = std::ios::trunc) {
+    std::ofstream output(path, std::ios::binary | mode);
+    output.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+FileIdentity identity(uint64_t inode) {
+    return FileIdentity{1, inode, inode * 10, static_cast<int64_t>(inode) * 1000};
+}
+
+using SyncManifestTest = TempDirectory;
+using BatchJournalTest = TempDirectory;
+
+const std::string Scope = SyncManifest::scope("account", "");
+
+}
+
+TEST_F(SyncManifestTest, ReloadsRecordsAndRemovals) {
+    {
+        SyncManifest manifest(file("manifest"), Scope);
+        ASSERT_TRUE(manifest.open());
+        manifest.record("/data/a", identity(1), "QmA");
+        manifest.record("/data/b", identity(2), "QmB");
+        manifest.record("/data/a", identity(3), "QmA2");
+        EXPECT_TRUE(manifest.remove("/data/b"));
+    }
+    SyncManifest manifest(file("manifest"), Scope);
+    ASSERT_TRUE(manifest.open());
+    EXPECT_EQ(manifest.size(), 1u);
+    EXPECT_EQ(manifest.unchangedCid("/data/a", identity(3)), "QmA2");
+    EXPECT_FALSE(manifest.unchangedCid("/data/a", identity(1)));
+    EXPECT_EQ(manifest.find("/data/b"), nullptr);
+}
+
+TEST_F(SyncManifestTest, DropsTornRecordAndRewritesFile) {
+    {
+        SyncManifest manifest(file("expected"), Scope);
+        ASSERT_TRUE(manifest.open());
+        manifest.record("/data/a", identity(1), "QmA");
+    }
+    {
+        SyncManifest manifest(file("manifest"), Scope);
+        ASSERT_TRUE(manifest.open());
+        manifest.record("/data/a", identity(1), "QmA");
+        manifest.record("/data/b", identity(2), "QmB");
+    }
+    fs::resize_file(file("manifest"), fs::file_size(file("manifest")) - 2);
+    {
+        SyncManifest manifest(file("manifest"), Scope);
+        ASSERT_TRUE(manifest.open());
+        EXPECT_EQ(manifest.size(), 1u);
+        EXPECT_EQ(manifest.unchangedCid("/data/a", identity(1)), "QmA");
+        EXPECT_EQ(manifest.find("/data/b"), nullptr);
+    }
+    EXPECT_EQ(readAll(file("manifest")), readAll(file("expected")));
+}
+
+TEST_F(SyncManifestTest, CompactsOnlyPastTheSlack) {
+    {
+        SyncManifest manifest(file("small"), Scope);
+        ASSERT_TRUE(manifest.open());
+        manifest.record("/data/a", identity(1), "QmA");
+    }
+    uint64_t oneRecord = fs::file_size(file("small"));
+    {
+        SyncManifest manifest(file("small"), Scope);
+        ASSERT_TRUE(manifest.open());
+        manifest.record("/data/a", identity(2), "QmA");
+    }
+    uint64_t recordSize = fs::file_size(file("small")) - oneRecord;
+
+    {
+        SyncManifest manifest(file("below"), Scope);
+        ASSERT_TRUE(manifest.open());
+        for (uint64_t i = 0; i < SyncManifest::CompactionSlack; ++i) manifest.record("/data/a", identity(1), "QmA");
+    }
+    EXPECT_EQ(fs::file_size(file("below")), oneRecord + (SyncManifest::CompactionSlack - 1) * recordSize);
+
+    {
+        SyncManifest manifest(file("above"), Scope);
+        ASSERT_TRUE(manifest.open());
+        for (uint64_t i = 0; i < SyncManifest::CompactionSlack + 10; ++i) manifest.record("/data/a", identity(1), "QmA");
+    }
+    EXPECT_EQ(fs::file_size(file("above")), oneRecord);
+}
+
+TEST_F(SyncManifestTest, RejectsOtherScopeAndVersion) {
+    {
+        SyncManifest manifest(file("manifest"), Scope);
+        ASSERT_TRUE(manifest.open());
+        manifest.record("/data/a", identity(1), "QmA");
+    }
+    SyncManifest otherScope(file("manifest"), SyncManifest::scope("account", "{\"name\":\"group\"}"));
+    auto opened = otherScope.open();
+    ASSERT_FALSE(opened);
+    EXPECT_NE(opened.error().find("different API endpoint, account or metadata"), std::string::npos);
+
+    writeAll(file("old"), std::string("PPSM\x01\x00", 6));
+    SyncManifest oldVersion(file("old"), Scope);
+    opened = oldVersion.open();
+    ASSERT_FALSE(opened);
+    EXPECT_NE(opened.error().find("unsupported version"), std::string::npos);
+}
+
+TEST_F(BatchJournalTest, RoundTripsEscapedPathsAndErrors) {
+    std::vector<std::string> files{file("tab\there"), file("new\nline"), file("back\\slash\\n"), file("plain")};
+    Json::Value metadata;
+    metadata["name"] = "a\tb\nc\\";
+    {
+        auto journal = BatchJournal::create(file("journal"), files, metadata);
+        ASSERT_TRUE(journal);
+        journal->record(files[0], std::string("QmTab"));
+        journal->record(files[1], std::unexpected(std::make_pair(IPFSError::PinataError, std::string("line one\nline\ttwo\\"))));
+        journal->record(files[2], std::string("QmSlash"));
+    }
+    auto journal = BatchJournal::resume(file("journal"));
+    ASSERT_TRUE(journal);
+    EXPECT_EQ(journal->files(), files);
+    ASSERT_TRUE(journal->metadata());
+    EXPECT_EQ((*journal->metadata())["name"].asString(), "a\tb\nc\\");
+    EXPECT_EQ(journal->uploaded().at(files[0]), "QmTab");
+    EXPECT_EQ(journal->uploaded().at(files[2]), "QmSlash");
+    EXPECT_EQ(journal->failed().at(files[1]), IPFSClient::errorToString({IPFSError::PinataError, "line one\nline\ttwo\\"}));
+    EXPECT_EQ(journal->remaining(), (std::vector<std::string>{files[1], files[3]}));
+}
+
+TEST_F(BatchJournalTest, DropsTornTailOnResume) {
+    std::vector<std::string> files{file("a"), file("b"), file("c")};
+    {
+        auto journal = BatchJournal::create(file("journal"), files, std::nullopt);
+        ASSERT_TRUE(journal);
+        journal->record(files[0], std::string("QmA"));
+    }
+    uint64_t complete = fs::file_size(file("journal"));
+    writeAll(file("journal"), "done\tQmB\t" + files[1], std::ios::app);
+    {
+        auto journal = BatchJournal::resume(file("journal"));
+        ASSERT_TRUE(journal);
+        EXPECT_EQ(fs::file_size(file("journal")), complete);
+        EXPECT_EQ(journal->uploaded().size(), 1u);
+        EXPECT_EQ(journal->remaining(), (std::vector<std::string>{files[1], files[2]}));
+        journal->record(files[1], std::string("QmB"));
+    }
+    auto journal = BatchJournal::resume(file("journal"));
+    ASSERT_TRUE(journal);
+    EXPECT_EQ(journal->uploaded().at(files[1]), "QmB");
+    EXPECT_EQ(journal->remaining(), std::vector<std::string>{files[2]});
+}
+
+TEST_F(BatchJournalTest, RejectsUnstartedAndExistingJournals) {
+    writeAll(file("unstarted"), std::string(BatchJournal::Magic) + "\nplan\t/data/a\n");
+    auto resumed = BatchJournal::resume(file("unstarted"));
+    ASSERT_FALSE(resumed);
+    EXPECT_NE(resumed.error().find("interrupted before the batch started"), std::string::npos);
+
+    auto created = BatchJournal::create(file("unstarted"), {file("a")}, std::nullopt);
+    ASSERT_FALSE(created);
+    EXPECT_NE(created.error().find("already exists"), std::string::npos);
+}
+
+TEST(LatencyHistogramTest, BucketsCoverValuesWithBoundedError) {
+    for (uint64_t value = 0; value < LatencyHistogram::LinearBuckets; ++value) {
+        EXPECT_EQ(LatencyHistogram::bucketIndex(value), value);
+        EXPECT_EQ(LatencyHistogram::bucketUpperBound(value), value);
+    }
+    size_t previous = 0;
+    for (uint64_t value = LatencyHistogram::LinearBuckets; value < (uint64_t(1) << 36); value += value / 7 + 1) {
+        size_t index = LatencyHistogram::bucketIndex(value);
+        uint64_t bound = LatencyHistogram::bucketUpperBound(index);
+        EXPECT_GE(index, previous);
+        EXPECT_GE(bound, value);
+        EXPECT_LE(bound - value, value / LatencyHistogram::SubBuckets);
+        EXPECT_EQ(LatencyHistogram::bucketIndex(bound), index);
+        EXPECT_EQ(LatencyHistogram::bucketIndex(bound + 1), index + 1);
+        previous = index;
+    }
+    EXPECT_EQ(LatencyHistogram::bucketIndex(UINT64_MAX), LatencyHistogram::BucketCount - 1);
+}
+
+TEST(LatencyHistogramTest, PercentilesStayWithinBucketPrecision) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.snapshot().percentileUs(50), 0u);
+    for (uint64_t value = 1; value <= 10000; ++value) histogram.record(value);
+    LatencySnapshot snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 10000u);
+    EXPECT_EQ(snapshot.maxUs, 10000u);
+    for (double percentile : {1.0, 50.0, 90.0, 99.0, 99.9}) {
+        auto exact = static_cast<uint64_t>(std::ceil(percentile / 100.0 * 10000));
+        uint64_t reported = snapshot.percentileUs(percentile);
+        EXPECT_GE(reported, exact);
+        EXPECT_LE(reported - exact, exact / LatencyHistogram::SubBuckets);
+    }
+    EXPECT_EQ(snapshot.percentileUs(100), 10000u);
+    EXPECT_EQ(snapshot.percentileUs(0), 1u);
+}
@@ -0,0 +1,84 @@
+#include "mock_server.hpp"
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void printUsage() {
+    std::cout << "Usage: pinatapipe_mock_server [options]\n";
+    std::cout << "Options:\n";
+    std::cout << "  --port <n>                    Port to listen on, 0 for any free port (default: 8787)\n";
+    std::cout << "  --any-address                 Listen on all interfaces instead of 127.0.0.1\n";
+    std::cout << "  --no-auth                     Accept requests without pinata_api_key headers\n";
+    std::cout << "  --latency-ms <n>              Delay before every response\n";
+    std::cout << "  --jitter-ms <n>               Add up to <n> ms of random delay\n";
+    std::cout << "  --bandwidth <bytes/s>         Per-connection bandwidth limit in both directions\n";
+    std::cout << "  --rate-limit-every <n>        Answer every <n>th request with 429\n";
+    std::cout << "  --rate-limit-probability <p>  Answer a random fraction of requests with 429\n";
+    std::cout << "  --reset-probability <p>       Reset a random fraction of connections after the request\n";
+    std::cout << "  --retry-after <s>             Retry-After value sent with 429 responses (default: 1)\n";
+    std::cout << "  --gateway-size <bytes>        Size of gateway content for unknown CIDs (default: 1048576)\n";
+    std::cout << "  --replay <trace>              Reproduce per-endpoint latencies, statuses and resets from a pinatapipe --record trace\n";
+    std::cout << "  --seed <n>                    Random seed for jitter and fault injection\n";
+    std::cout << "Settings can be changed at runtime with GET /_mock/config?latency_ms=..&bandwidth=..&rate_limit_every=..\n";
+    std::cout << "&rate_limit_probability=..&reset_probability=..&jitter_ms=.., and counters read from GET /_mock/stats.\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    MockServerOptions options;
+    std::string replayPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--port" && hasValue) options.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        else if (arg == "--any-address") options.loopbackOnly = false;
+        else if (arg == "--no-auth") options.requireAuth = false;
+        else if (arg == "--latency-ms" && hasValue) options.latencyMs = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--jitter-ms" && hasValue) options.jitterMs = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--bandwidth" && hasValue) options.bandwidthBytesPerSecond = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--rate-limit-every" && hasValue) options.rateLimitEvery = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--rate-limit-probability" && hasValue) options.rateLimitProbability = std::atof(argv[++i]);
+        else if (arg == "--reset-probability" && hasValue) options.resetProbability = std::atof(argv[++i]);
+        else if (arg == "--retry-after" && hasValue) options.retryAfterSeconds = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--gateway-size" && hasValue) options.gatewaySize = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--replay" && hasValue) replayPath = argv[++i];
+        else if (arg == "--seed" && hasValue) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    MockPinataServer server(options);
+    if (!replayPath.empty()) {
+        auto trace = RequestRecorder::read(replayPath);
+        if (!trace) {
+            std::cerr << trace.error() << "\n";
+            return 1;
+        }
+        server.replay(*trace);
+        std::cout << "Replaying " << trace->requests.size() << " recorded requests from " << replayPath << std::endl;
+    }
+    auto started = server.start();
+    if (!started) {
+        std::cerr << started.error() << "\n";
+        return 1;
+    }
+    std::cout << "Mock Pinata API listening on " << server.apiUrl() << " (gateway " << server.gatewayUrl() << ")" << std::endl;
+
+    std::signal(SIGINT, [](int) { stopRequested = 1; });
+    std::signal(SIGTERM, [](int) { stopRequested = 1; });
+    while (!stopRequested) pause();
+
+    server.stop();
+    MockServerStats stats = server.stats();
+    std::cout << "Served " << stats.requests << " requests (" << stats.uploads << " uploads, " << stats.rateLimited << " rate limited, " << stats.resets
+              << " resets, " << stats.replayed << " replayed), received " << stats.bytesReceived << " bytes, sent " << stats.bytesSent << " bytes\n";
+    return 0;
+}
@@ -0,0 +1,590 @@
+#include "mock_server.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <json/json.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t ReadChunk = 64 * 1024;
+constexpr size_t BodyHeadLimit = 16 * 1024;
+constexpr size_t BodyTailLimit = 64 * 1024;
+constexpr uint64_t FnvOffset = 14695981039346656037ull;
+constexpr uint64_t FnvPrime = 1099511628211ull;
+
+bool sendAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent <= 0) return false;
+        data.remove_prefix(static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+std::string lower(std::string_view value) {
+    std::string result(value);
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return std::tolower(c); });
+    return result;
+}
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t' || value.back() == '\r')) value.remove_suffix(1);
+    return value;
+}
+
+std::string urlDecode(std::string_view value) {
+    std::string result;
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] == '%' && i + 2 < value.size()) {
+            unsigned code = 0;
+            auto [ptr, ec] = std::from_chars(value.data() + i + 1, value.data() + i + 3, code, 16);
+            if (ec == std::errc() && ptr == value.data() + i + 3) {
+                result += static_cast<char>(code);
+                i += 2;
+                continue;
+            }
+        }
+        result += value[i] == '+' ? ' ' : value[i];
+    }
+    return result;
+}
+
+std::map<std::string, std::string> parseQuery(std::string_view query) {
+    std::map<std::string, std::string> result;
+    while (!query.empty()) {
+        size_t end = query.find('&');
+        std::string_view pair = query.substr(0, end);
+        size_t equals = pair.find('=');
+        if (equals == std::string_view::npos) result[urlDecode(pair)] = "";
+        else result[urlDecode(pair.substr(0, equals))] = urlDecode(pair.substr(equals + 1));
+        if (end == std::string_view::npos) break;
+        query.remove_prefix(end + 1);
+    }
+    return result;
+}
+
+uint64_t toNumber(const std::string& value, uint64_t fallback) {
+    uint64_t result = 0;
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+    return ec == std::errc() ? result : fallback;
+}
+
+std::string writeJson(const Json::Value& value) {
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    return Json::writeString(writer, value);
+}
+
+std::string nowIso8601() {
+    return std::format("{:%Y-%m-%dT%H:%M:%S}Z", std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()));
+}
+
+char contentByte(uint64_t offset) {
+    return static_cast<char>('a' + (offset * 7 + offset / 4096) % 26);
+}
+
+std::string_view endpointFor(const std::string& path) {
+    if (path == "/pinning/pinFileToIPFS") return "pinFileToIPFS";
+    if (path == "/data/pinList") return "pinList";
+    if (path.starts_with("/pinning/unpin/")) return "unpin";
+    if (path == "/data/testAuthentication") return "testAuthentication";
+    if (path.starts_with("/ipfs/")) return "gateway";
+    return {};
+}
+
+const char* statusText(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 206: return "Partial Content";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 416: return "Range Not Satisfiable";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 502: return "Bad Gateway";
+    case 503: return "Service Unavailable";
+    case 504: return "Gateway Timeout";
+    default: return "Error";
+    }
+}
+
+}
+
+void MockPinataServer::Throttle::account(size_t bytes) {
+    uint64_t limit = rate.load(std::memory_order_relaxed);
+    total += bytes;
+    if (limit == 0) return;
+    auto due = started + std::chrono::microseconds(total * 1000000 / limit);
+    auto now = std::chrono::steady_clock::now();
+    if (due > now) std::this_thread::sleep_for(due - now);
+}
+
+MockPinataServer::MockPinataServer(const MockServerOptions& options)
+    : latencyMs(options.latencyMs), jitterMs(options.jitterMs), bandwidth(options.bandwidthBytesPerSecond), rateLimitEvery(options.rateLimitEvery),
+      rateLimitProbability(options.rateLimitProbability), resetProbability(options.resetProbability), options(options), random(options.seed) {}
+
+MockPinataServer::~MockPinataServer() {
+    stop();
+}
+
+void MockPinataServer::replay(const RecordedTrace& trace) {
+    std::lock_guard<std::mutex> lock(replayMutex);
+    replaySamples.clear();
+    replayPositions.clear();
+    for (const auto& request : trace.requests) {
+        if (request.endpoint < trace.endpoints.size()) replaySamples[trace.endpoints[request.endpoint]].push_back(request);
+    }
+}
+
+std::expected<void, std::string> MockPinataServer::start() {
+    listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) return std::unexpected(std::string("socket: ") + std::strerror(errno));
+    int reuse = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(options.loopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+    address.sin_port = htons(options.port);
+    socklen_t addressLength = sizeof(address);
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 128) != 0
+        || ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &addressLength) != 0) {
+        std::string error = std::format("Could not listen on port {}: {}", options.port, std::strerror(errno));
+        ::close(listener);
+        listener = -1;
+        return std::unexpected(error);
+    }
+    boundPort = ntohs(address.sin_port);
+    running = true;
+    acceptor = std::thread(&MockPinataServer::acceptLoop, this);
+    return {};
+}
+
+void MockPinataServer::stop() {
+    if (!running.exchange(false)) return;
+    ::shutdown(listener, SHUT_RDWR);
+    ::close(listener);
+    listener = -1;
+    acceptor.join();
+    std::unique_lock<std::mutex> lock(connectionsMutex);
+    for (int fd : connections) ::shutdown(fd, SHUT_RDWR);
+    connectionsDone.wait(lock, [this] { return connections.empty(); });
+}
+
+std::string MockPinataServer::apiUrl() const {
+    return std::format("http://127.0.0.1:{}/", boundPort);
+}
+
+std::string MockPinataServer::gatewayUrl() const {
+    return std::format("http://127.0.0.1:{}/ipfs/", boundPort);
+}
+
+MockServerStats MockPinataServer::stats() const {
+    MockServerStats result;
+    result.requests = requests.load(std::memory_order_relaxed);
+    result.uploads = uploads.load(std::memory_order_relaxed);
+    result.bytesReceived = bytesReceived.load(std::memory_order_relaxed);
+    result.bytesSent = bytesSent.load(std::memory_order_relaxed);
+    result.rateLimited = rateLimited.load(std::memory_order_relaxed);
+    result.resets = resets.load(std::memory_order_relaxed);
+    result.replayed = replayed.load(std::memory_order_relaxed);
+    return result;
+}
+
+void MockPinataServer::acceptLoop() {
+    while (running) {
+        int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (!running) return;
+            continue;
+        }
+        int noDelay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        connections.push_back(fd);
+        std::thread(&MockPinataServer::serve, this, fd).detach();
+    }
+}
+
+void MockPinataServer::serve(int fd) {
+    std::string pending;
+    Throttle throttle(bandwidth);
+    for (;;) {
+        Request request;
+        if (!readRequest(fd, pending, request, throttle)) break;
+        requests.fetch_add(1, std::memory_order_relaxed);
+
+        if (auto sample = nextReplay(request)) {
+            replayed.fetch_add(1, std::memory_order_relaxed);
+            uint32_t until = sample->curlResult != 0 ? sample->totalUs : sample->startTransferUs;
+            std::this_thread::sleep_until(request.arrived + std::chrono::microseconds(until > sample->preTransferUs ? until - sample->preTransferUs : 0));
+            if (sample->curlResult != 0) {
+                resets.fetch_add(1, std::memory_order_relaxed);
+                linger abort {1, 0};
+                ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &abort, sizeof(abort));
+                break;
+            }
+            Response response = sample->httpStatus >= 300 ? replayError(*sample) : route(request);
+            uint32_t receiveUs = sample->totalUs > sample->startTransferUs ? sample->totalUs - sample->startTransferUs : 0;
+            std::atomic<uint64_t> rate{receiveUs > 0 && sample->bytesDown > 0 ? std::max<uint64_t>(1, sample->bytesDown * 1000000 / receiveUs) : 0};
+            Throttle paced(rate);
+            if (!writeResponse(fd, request, response, paced)) break;
+            continue;
+        }
+
+        if (chance(resetProbability.load(std::memory_order_relaxed)) && !request.path.starts_with("/_mock/")) {
+            resets.fetch_add(1, std::memory_order_relaxed);
+            linger abort {1, 0};
+            ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &abort, sizeof(abort));
+            break;
+        }
+
+        uint64_t delay = latencyMs.load(std::memory_order_relaxed);
+        uint64_t jitter = jitterMs.load(std::memory_order_relaxed);
+        if (jitter > 0) {
+            std::lock_guard<std::mutex> lock(randomMutex);
+            delay += random() % (jitter + 1);
+        }
+        if (delay > 0 && !request.path.starts_with("/_mock/")) std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+
+        Response response = route(request);
+        if (!writeResponse(fd, request, response, throttle)) break;
+        auto connection = request.headers.find("connection");
+        if (connection != request.headers.end() && lower(connection->second) == "close") break;
+    }
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    connections.erase(std::remove(connections.begin(), connections.end(), fd), connections.end());
+    ::close(fd);
+    connectionsDone.notify_all();
+}
+
+bool MockPinataServer::readRequest(int fd, std::string& pending, Request& request, Throttle& throttle) {
+    char buffer[ReadChunk];
+    size_t headerEnd;
+    while ((headerEnd = pending.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) return false;
+        pending.append(buffer, static_cast<size_t>(received));
+        addBytes(bytesReceived, static_cast<size_t>(received));
+        throttle.account(static_cast<size_t>(received));
+    }
+    std::string_view head(pending.data(), headerEnd);
+    size_t lineEnd = head.find("\r\n");
+    std::string_view requestLine = head.substr(0, lineEnd);
+    size_t firstSpace = requestLine.find(' ');
+    size_t secondSpace = requestLine.find(' ', firstSpace + 1);
+    if (firstSpace == std::string_view::npos || secondSpace == std::string_view::npos) return false;
+    request.method = requestLine.substr(0, firstSpace);
+    std::string_view target = requestLine.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+    size_t question = target.find('?');
+    request.path = target.substr(0, question);
+    if (question != std::string_view::npos) request.query = target.substr(question + 1);
+
+    std::string_view rest = lineEnd == std::string_view::npos ? std::string_view() : head.substr(lineEnd + 2);
+    while (!rest.empty()) {
+        size_t end = rest.find("\r\n");
+        std::string_view line = rest.substr(0, end);
+        size_t colon = line.find(':');
+        if (colon != std::string_view::npos) request.headers[lower(trim(line.substr(0, colon)))] = trim(line.substr(colon + 1));
+        if (end == std::string_view::npos) break;
+        rest.remove_prefix(end + 2);
+    }
+    pending.erase(0, headerEnd + 4);
+    request.arrived = std::chrono::steady_clock::now();
+
+    auto expect = request.headers.find("expect");
+    if (expect != request.headers.end() && lower(expect->second) == "100-continue" && !sendAll(fd, "HTTP/1.1 100 Continue\r\n\r\n")) return false;
+    return readBody(fd, pending, request, throttle);
+}
+
+bool MockPinataServer::readBody(int fd, std::string& pending, Request& request, Throttle& throttle) {
+    char buffer[ReadChunk];
+    request.bodyHash = FnvOffset;
+    auto consume = [&request](std::string_view data) {
+        for (char c : data) request.bodyHash = (request.bodyHash ^ static_cast<unsigned char>(c)) * FnvPrime;
+        if (request.bodyHead.size() < BodyHeadLimit) request.bodyHead.append(data.substr(0, BodyHeadLimit - request.bodyHead.size()));
+        request.bodyTail.append(data.size() > BodyTailLimit ? data.substr(data.size() - BodyTailLimit) : data);
+        if (request.bodyTail.size() > 2 * BodyTailLimit) request.bodyTail.erase(0, request.bodyTail.size() - BodyTailLimit);
+        request.bodySize += data.size();
+    };
+    auto fill = [&](size_t wanted) {
+        while (pending.size() < wanted) {
+            ssize_t received = ::recv(fd, buffer, std::min(sizeof(buffer), std::max<size_t>(wanted - pending.size(), 1)), 0);
+            if (received <= 0) return false;
+            pending.append(buffer, static_cast<size_t>(received));
+            addBytes(bytesReceived, static_cast<size_t>(received));
+            throttle.account(static_cast<size_t>(received));
+        }
+        return true;
+    };
+
+    auto encoding = request.headers.find("transfer-encoding");
+    if (encoding != request.headers.end() && lower(encoding->second).find("chunked") != std::string::npos) {
+        for (;;) {
+            size_t lineEnd;
+            while ((lineEnd = pending.find("\r\n")) == std::string::npos) {
+                if (!fill(pending.size() + 1)) return false;
+            }
+            size_t chunkSize = 0;
+            std::from_chars(pending.data(), pending.data() + lineEnd, chunkSize, 16);
+            pending.erase(0, lineEnd + 2);
+            if (!fill(chunkSize + 2)) return false;
+            consume(std::string_view(pending.data(), chunkSize));
+            pending.erase(0, chunkSize + 2);
+            if (chunkSize == 0) return true;
+        }
+    }
+
+    auto length = request.headers.find("content-length");
+    uint64_t remaining = length == request.headers.end() ? 0 : toNumber(length->second, 0);
+    while (remaining > 0) {
+        if (pending.empty() && !fill(std::min<uint64_t>(remaining, ReadChunk))) return false;
+        size_t take = static_cast<size_t>(std::min<uint64_t>(remaining, pending.size()));
+        consume(std::string_view(pending.data(), take));
+        pending.erase(0, take);
+        remaining -= take;
+    }
+    return true;
+}
+
+bool MockPinataServer::writeResponse(int fd, const Request& request, const Response& response, Throttle& throttle) {
+    uint64_t bodySize = response.body.empty() ? response.generatedSize : response.body.size();
+    std::string head = std::format("HTTP/1.1 {} {}\r\nContent-Type: {}\r\nContent-Length: {}\r\n", response.status, statusText(response.status), response.contentType, bodySize);
+    for (const auto& [name, value] : response.headers) head += std::format("{}: {}\r\n", name, value);
+    head += "\r\n";
+    if (!sendAll(fd, head)) return false;
+    addBytes(bytesSent, head.size());
+    if (request.method == "HEAD") return true;
+
+    if (!response.body.empty()) {
+        for (std::string_view remaining = response.body; !remaining.empty();) {
+            std::string_view piece = remaining.substr(0, ReadChunk);
+            if (!sendAll(fd, piece)) return false;
+            addBytes(bytesSent, piece.size());
+            throttle.account(piece.size());
+            remaining.remove_prefix(piece.size());
+        }
+        return true;
+    }
+
+    std::string chunk;
+    for (uint64_t sent = 0; sent < response.generatedSize;) {
+        size_t size = static_cast<size_t>(std::min<uint64_t>(ReadChunk, response.generatedSize - sent));
+        chunk.resize(size);
+        for (size_t i = 0; i < size; ++i) chunk[i] = contentByte(response.generatedOffset + sent + i);
+        if (!sendAll(fd, chunk)) return false;
+        addBytes(bytesSent, size);
+        throttle.account(size);
+        sent += size;
+    }
+    return true;
+}
+
+bool MockPinataServer::chance(double probability) {
+    if (probability <= 0.0) return false;
+    std::lock_guard<std::mutex> lock(randomMutex);
+    return std::uniform_real_distribution<double>(0.0, 1.0)(random) < probability;
+}
+
+std::optional<RecordedRequest> MockPinataServer::nextReplay(const Request& request) {
+    std::string_view endpoint = endpointFor(request.path);
+    std::lock_guard<std::mutex> lock(replayMutex);
+    auto samples = replaySamples.find(endpoint);
+    if (endpoint.empty() || samples == replaySamples.end()) return std::nullopt;
+    size_t& position = replayPositions[samples->first];
+    const RecordedRequest& sample = samples->second[position];
+    position = (position + 1) % samples->second.size();
+    return sample;
+}
+
+MockPinataServer::Response MockPinataServer::replayError(const RecordedRequest& sample) {
+    Response response {sample.httpStatus, "application/json", {}, std::format(R"({{"error":{{"reason":"REPLAYED_ERROR","details":"HTTP {} replayed from trace"}}}})", sample.httpStatus)};
+    if (sample.httpStatus == 429) {
+        rateLimited.fetch_add(1, std::memory_order_relaxed);
+        response.headers.emplace_back("Retry-After", std::to_string(options.retryAfterSeconds));
+    }
+    return response;
+}
+
+MockPinataServer::Response MockPinataServer::route(const Request& request) {
+    if (request.path.starts_with("/_mock/")) return control(request);
+
+    bool gatewayRequest = request.path.starts_with("/ipfs/");
+    if (!gatewayRequest && options.requireAuth
+        && (!request.headers.contains("pinata_api_key") || !request.headers.contains("pinata_secret_api_key"))) {
+        return {401, "application/json", {}, R"({"error":{"reason":"INVALID_CREDENTIALS","details":"Missing pinata_api_key or pinata_secret_api_key"}})"};
+    }
+
+    uint64_t every = rateLimitEvery.load(std::memory_order_relaxed);
+    uint64_t index = requests.load(std::memory_order_relaxed);
+    if ((every > 0 && index % every == 0) || chance(rateLimitProbability.load(std::memory_order_relaxed))) {
+        rateLimited.fetch_add(1, std::memory_order_relaxed);
+        return {429, "application/json", {{"Retry-After", std::to_string(options.retryAfterSeconds)}}, R"({"error":{"reason":"RATE_LIMITED","details":"Too many requests"}})"};
+    }
+
+    if (gatewayRequest && (request.method == "GET" || request.method == "HEAD")) return gateway(request);
+    if (request.method == "POST" && request.path == "/pinning/pinFileToIPFS") return upload(request);
+    if (request.method == "GET" && request.path == "/data/pinList") return pinList(request);
+    if (request.method == "DELETE" && request.path.starts_with("/pinning/unpin/")) return unpin(request);
+    if ((request.method == "GET" || request.method == "HEAD") && request.path == "/data/testAuthentication") {
+        return {200, "application/json", {}, R"({"message":"Congratulations! You are communicating with the Pinata API!"})"};
+    }
+    return {404, "application/json", {}, R"({"error":{"reason":"NOT_FOUND","details":"Unknown endpoint"}})"};
+}
+
+MockPinataServer::Response MockPinataServer::control(const Request& request) {
+    if (request.path == "/_mock/config") {
+        for (const auto& [key, value] : parseQuery(request.query)) {
+            if (key == "latency_ms") latencyMs = toNumber(value, latencyMs);
+            else if (key == "jitter_ms") jitterMs = toNumber(value, jitterMs);
+            else if (key == "bandwidth") bandwidth = toNumber(value, bandwidth);
+            else if (key == "rate_limit_every") rateLimitEvery = toNumber(value, rateLimitEvery);
+            else if (key == "rate_limit_probability") rateLimitProbability = std::atof(value.c_str());
+            else if (key == "reset_probability") resetProbability = std::atof(value.c_str());
+            else return {400, "application/json", {}, std::format(R"({{"error":"unknown setting {}"}})", key)};
+        }
+        Json::Value config;
+        config["latency_ms"] = Json::UInt64(latencyMs.load());
+        config["jitter_ms"] = Json::UInt64(jitterMs.load());
+        config["bandwidth"] = Json::UInt64(bandwidth.load());
+        config["rate_limit_every"] = Json::UInt64(rateLimitEvery.load());
+        config["rate_limit_probability"] = rateLimitProbability.load();
+        config["reset_probability"] = resetProbability.load();
+        return {200, "application/json", {}, writeJson(config)};
+    }
+    if (request.path == "/_mock/stats") {
+        MockServerStats current = stats();
+        Json::Value result;
+        result["requests"] = Json::UInt64(current.requests);
+        result["uploads"] = Json::UInt64(current.uploads);
+        result["bytes_received"] = Json::UInt64(current.bytesReceived);
+        result["bytes_sent"] = Json::UInt64(current.bytesSent);
+        result["rate_limited"] = Json::UInt64(current.rateLimited);
+        result["resets"] = Json::UInt64(current.resets);
+        result["replayed"] = Json::UInt64(current.replayed);
+        return {200, "application/json", {}, writeJson(result)};
+    }
+    return {404, "application/json", {}, R"({"error":"unknown control endpoint"})"};
+}
+
+MockPinataServer::Response MockPinataServer::upload(const Request& request) {
+    uploads.fetch_add(1, std::memory_order_relaxed);
+    Pin pin;
+    pin.size = request.bodySize;
+    pin.timestamp = nowIso8601();
+
+    constexpr std::string_view metadataMarker = "name=\"pinataMetadata\"";
+    if (size_t marker = request.bodyTail.rfind(metadataMarker); marker != std::string::npos) {
+        size_t start = request.bodyTail.find("\r\n\r\n", marker);
+        size_t end = start == std::string::npos ? start : request.bodyTail.find("\r\n--", start + 4);
+        if (end != std::string::npos) {
+            Json::Value metadata;
+            Json::CharReaderBuilder builder;
+            std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+            const char* begin = request.bodyTail.data() + start + 4;
+            if (reader->parse(begin, request.bodyTail.data() + end, &metadata, nullptr)) pin.name = metadata.get("name", "").asString();
+        }
+    }
+    if (pin.name.empty()) {
+        constexpr std::string_view filenameMarker = "filename=\"";
+        if (size_t marker = request.bodyHead.find(filenameMarker); marker != std::string::npos) {
+            size_t start = marker + filenameMarker.size();
+            pin.name = request.bodyHead.substr(start, request.bodyHead.find('"', start) - start);
+        }
+    }
+
+    std::string cid = std::format("QmMock{:016x}{:024x}", request.bodyHash, request.bodySize);
+    {
+        std::lock_guard<std::mutex> lock(pinsMutex);
+        pins[cid] = pin;
+    }
+    Json::Value result;
+    result["IpfsHash"] = cid;
+    result["PinSize"] = Json::UInt64(pin.size);
+    result["Timestamp"] = pin.timestamp;
+    return {200, "application/json", {}, writeJson(result)};
+}
+
+MockPinataServer::Response MockPinataServer::pinList(const Request& request) {
+    auto query = parseQuery(request.query);
+    auto name = query.find("metadata[name]");
+    uint64_t limit = toNumber(query.contains("pageLimit") ? query["pageLimit"] : "", 10);
+    Json::Value result;
+    result["rows"] = Json::Value(Json::arrayValue);
+    uint64_t count = 0;
+    std::lock_guard<std::mutex> lock(pinsMutex);
+    for (const auto& [cid, pin] : pins) {
+        if (name != query.end() && pin.name != name->second) continue;
+        ++count;
+        if (result["rows"].size() >= limit) continue;
+        Json::Value row;
+        row["ipfs_pin_hash"] = cid;
+        row["size"] = Json::UInt64(pin.size);
+        row["date_pinned"] = pin.timestamp;
+        row["metadata"]["name"] = pin.name;
+        row["metadata"]["keyvalues"] = Json::Value(Json::nullValue);
+        result["rows"].append(row);
+    }
+    result["count"] = Json::UInt64(count);
+    return {200, "application/json", {}, writeJson(result)};
+}
+
+MockPinataServer::Response MockPinataServer::unpin(const Request& request) {
+    std::string cid = request.path.substr(std::string_view("/pinning/unpin/").size());
+    std::lock_guard<std::mutex> lock(pinsMutex);
+    if (pins.erase(cid) == 0) {
+        return {400, "application/json", {}, R"({"error":{"reason":"CURRENT_USER_HAS_NOT_PINNED_CID","details":"Current user has not pinned the cid"}})"};
+    }
+    return {200, "text/plain", {}, "OK"};
+}
+
+MockPinataServer::Response MockPinataServer::gateway(const Request& request) {
+    std::string cid = request.path.substr(std::string_view("/ipfs/").size());
+    cid = cid.substr(0, cid.find('/'));
+    uint64_t size = options.gatewaySize;
+    {
+        std::lock_guard<std::mutex> lock(pinsMutex);
+        if (auto pin = pins.find(cid); pin != pins.end()) size = pin->second.size;
+    }
+
+    Response response;
+    response.contentType = "application/octet-stream";
+    response.headers.emplace_back("Accept-Ranges", "bytes");
+    response.generatedSize = size;
+    auto range = request.headers.find("range");
+    if (range == request.headers.end() || !range->second.starts_with("bytes=") || range->second.find(',') != std::string::npos) return response;
+
+    std::string_view spec = std::string_view(range->second).substr(6);
+    size_t dash = spec.find('-');
+    if (dash == std::string_view::npos) return response;
+    std::string first(spec.substr(0, dash));
+    std::string last(spec.substr(dash + 1));
+    uint64_t start = 0;
+    uint64_t end = size == 0 ? 0 : size - 1;
+    if (first.empty()) {
+        uint64_t suffix = toNumber(last, 0);
+        start = suffix >= size ? 0 : size - suffix;
+    } else {
+        start = toNumber(first, 0);
+        if (!last.empty()) end = std::min(end, toNumber(last, end));
+    }
+    if (size == 0 || start >= size || start > end) {
+        return {416, "application/json", {{"Content-Range", std::format("bytes */{}", size)}}, R"({"error":"range not satisfiable"})"};
+    }
+    response.status = 206;
+    response.generatedOffset = start;
+    response.generatedSize = end - start + 1;
+    response.headers.emplace_back("Content-Range", std::format("bytes {}-{}/{}", start, end, size));
+    return response;
+}
@@ -0,0 +1,148 @@
+#ifndef MOCK_SERVER_HPP
+#define MOCK_SERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "request_recorder.hpp"
+
+struct MockServerOptions {
+    uint16_t port = 8787;
+    bool loopbackOnly = true;
+    bool requireAuth = true;
+    uint64_t latencyMs = 0;
+    uint64_t jitterMs = 0;
+    uint64_t bandwidthBytesPerSecond = 0;
+    uint64_t rateLimitEvery = 0;
+    double rateLimitProbability = 0.0;
+    double resetProbability = 0.0;
+    uint64_t retryAfterSeconds = 1;
+    uint64_t gatewaySize = 1024 * 1024;
+    uint64_t seed = 42;
+};
+
+struct MockServerStats {
+    uint64_t requests = 0;
+    uint64_t uploads = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t bytesSent = 0;
+    uint64_t rateLimited = 0;
+    uint64_t resets = 0;
+    uint64_t replayed = 0;
+};
+
+class MockPinataServer {
+public:
+    explicit MockPinataServer(const MockServerOptions& options);
+    MockPinataServer(const MockPinataServer&) = delete;
+    MockPinataServer& operator=(const MockPinataServer&) = delete;
+    ~MockPinataServer();
+
+    void replay(const RecordedTrace& trace);
+    std::expected<void, std::string> start();
+    void stop();
+    uint16_t port() const { return boundPort; }
+    std::string apiUrl() const;
+    std::string gatewayUrl() const;
+    MockServerStats stats() const;
+
+private:
+    struct Request {
+        std::string method;
+        std::string path;
+        std::string query;
+        std::map<std::string, std::string> headers;
+        uint64_t bodySize = 0;
+        uint64_t bodyHash = 0;
+        std::string bodyHead;
+        std::string bodyTail;
+        std::chrono::steady_clock::time_point arrived;
+    };
+
+    struct Response {
+        int status = 200;
+        std::string contentType = "application/json";
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::string body;
+        uint64_t generatedSize = 0;
+        uint64_t generatedOffset = 0;
+        bool reset = false;
+    };
+
+    struct Pin {
+        std::string name;
+        uint64_t size = 0;
+        std::string timestamp;
+    };
+
+    class Throttle {
+    public:
+        explicit Throttle(const std::atomic<uint64_t>& rate) : rate(rate) {}
+        void account(size_t bytes);
+
+    private:
+        const std::atomic<uint64_t>& rate;
+        std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+        uint64_t total = 0;
+    };
+
+    void acceptLoop();
+    void serve(int fd);
+    bool readRequest(int fd, std::string& pending, Request& request, Throttle& throttle);
+    bool readBody(int fd, std::string& pending, Request& request, Throttle& throttle);
+    bool writeResponse(int fd, const Request& request, const Response& response, Throttle& throttle);
+    std::optional<RecordedRequest> nextReplay(const Request& request);
+    Response replayError(const RecordedRequest& sample);
+    Response route(const Request& request);
+    Response control(const Request& request);
+    Response upload(const Request& request);
+    Response pinList(const Request& request);
+    Response unpin(const Request& request);
+    Response gateway(const Request& request);
+    bool chance(double probability);
+    void addBytes(std::atomic<uint64_t>& counter, size_t bytes) { counter.fetch_add(bytes, std::memory_order_relaxed); }
+
+    std::atomic<uint64_t> latencyMs;
+    std::atomic<uint64_t> jitterMs;
+    std::atomic<uint64_t> bandwidth;
+    std::atomic<uint64_t> rateLimitEvery;
+    std::atomic<double> rateLimitProbability;
+    std::atomic<double> resetProbability;
+    MockServerOptions options;
+
+    int listener = -1;
+    uint16_t boundPort = 0;
+    std::atomic<bool> running{false};
+    std::thread acceptor;
+    std::mutex connectionsMutex;
+    std::vector<int> connections;
+    std::condition_variable connectionsDone;
+
+    std::mutex pinsMutex;
+    std::map<std::string, Pin> pins;
+    std::mutex replayMutex;
+    std::map<std::string, std::vector<RecordedRequest>, std::less<>> replaySamples;
+    std::map<std::string, size_t, std::less<>> replayPositions;
+    std::mutex randomMutex;
+    std::mt19937_64 random;
+
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> uploads{0};
+    std::atomic<uint64_t> bytesReceived{0};
+    std::atomic<uint64_t> bytesSent{0};
+    std::atomic<uint64_t> rateLimited{0};
+    std::atomic<uint64_t> resets{0};
+    std::atomic<uint64_t> replayed{0};
+};
+
+#endif